@@ -43,117 +43,75 @@ AutoRobot::AutoRobot(
     qreal elide_rot,
     qreal rot_speed,
     QObject *parent
-) : Robot(position, angle, speed, parent),
-    sspeed(speed),
-    rot_remain(0),
-    elide_dist(elide_dist),
-    elide_rot(elide_rot),
-    rot_speed(rot_speed)
-{
+) : Robot(
+    position,
+    RobotState::automatic(
+        Vec2{ 0, 0 },
+        angle,
+        speed,
+        elide_dist,
+        elide_rot,
+        rot_speed
+    ),
+    parent
+) {
     setBrush(QBrush(QColor(0x55, 0x55, 0xcc)));
 }
 
-AutoRobot::AutoRobot(Robot *r) :
-    Robot(r),
-    sspeed(r->speed()),
-    rot_remain(0),
-    elide_dist(20),
-    elide_rot(M_PI / M_E),
-    rot_speed(M_PI / 4)
+AutoRobot::AutoRobot(RobotState state, QObject *parent) :
+    Robot(state, parent)
 {
     setBrush(QBrush(QColor(0x55, 0x55, 0xcc)));
+}
+
+AutoRobot::AutoRobot(Robot *r) : Robot(r) {
+    setBrush(QBrush(QColor(0x55, 0x55, 0xcc)));
+
+    rstate.kind = RobotKind::Auto;
+    rstate.sspeed = r->speed();
+    rstate.rot_remain = 0;
+    rstate.elide_dist = 20;
+    rstate.elide_rot = M_PI / M_E;
+    rstate.rot_speed = M_PI / 4;
 
     auto arob = dynamic_cast<AutoRobot *>(r);
     if (arob) {
-        elide_dist = arob->elide_dist;
-        elide_rot = arob->elide_rot;
-        rot_speed = arob->rot_speed;
+        rstate.elide_dist = arob->rstate.elide_dist;
+        rstate.elide_rot = arob->rstate.elide_rot;
+        rstate.rot_speed = arob->rstate.rot_speed;
     }
 
     auto crob = dynamic_cast<ControlRobot *>(r);
     if (crob) {
-        rot_speed = crob->rspeed();
-    }
-}
-
-void AutoRobot::move(qreal delta, qreal distance) {
-    if (rot_remain == 0 && distance <= elide_dist) {
-        rot_remain = elide_rot;
-        sspeed = Robot::speed();
-        Robot::set_speed(0);
-    }
-
-    if (rot_remain != 0) {
-        auto ang = rot_speed * delta;
-        ang = rot_remain < 0 ? -ang : ang;
-        if (qAbs(rot_remain) < qAbs(ang)) {
-            ang = rot_remain;
-            rot_remain = 0;
-        } else {
-            rot_remain -= ang;
-        }
-
-        set_angle(orientation() + ang);
-
-        if (rot_remain == 0) {
-            Robot::set_speed(sspeed);
-        }
+        rstate.rot_speed = crob->rspeed();
     }
-
-    Robot::move(delta, distance);
-}
-
-qreal AutoRobot::speed() {
-    if (rot_remain != 0) {
-        return sspeed;
-    } else {
-        return Robot::speed();
-    }
-}
-
-void AutoRobot::set_speed(qreal speed) {
-    if (rot_remain != 0) {
-        sspeed = speed;
-    } else {
-        Robot::set_speed(speed);
-    }
-}
-
-void AutoRobot::save(ofstream &file) {
-    auto ang = get_mod_angle(360);
-    if (ang < -180) {
-        ang += 360;
-    }
-
-    file << "auto_robot: [" << hitbox().x() << ", " << hitbox().y()
-        << "] { speed: " << speed() << ", rotation_speed: "
-        << rot_speed / M_PI * 180 << ", elide_distance: " << elide_dist
-        << ", elide_rotation: " << elide_rot / M_PI * 180
-        << ", angle: " << ang << " }" << endl;
 }
 
 qreal AutoRobot::edist() const {
-    return elide_dist;
+    return rstate.elide_dist;
 }
 
 void AutoRobot::set_edist(qreal dist) {
-    elide_dist = dist;
+    rstate.elide_dist = dist;
+    commit_params();
 }
 
 qreal AutoRobot::rspeed() const {
-    return rot_speed;
+    return rstate.rot_speed;
 }
 
 void AutoRobot::set_rspeed(qreal rspeed) {
-    rot_speed = rspeed;
+    rstate.rot_speed = rspeed;
+    commit_params();
 }
 
 qreal AutoRobot::rdist() const {
-    return elide_rot;
+    return rstate.elide_rot;
 }
 
 void AutoRobot::set_rdist(qreal dist) {
-    elide_rot = dist;
+    rstate.elide_rot = dist;
+    commit_params();
 }
 
 } // namespace icp
@@ -64,27 +64,12 @@ public:
     explicit AutoRobot(Robot *r);
 
     /**
-     * @brief Moves the robot.
-     * @param delta How much time (in second) passed since the last tick.
-     * @param distance Distance to the closest obstacle in front of the robot.
+     * @brief Creates the robot from its simulation state.
+     * @param state The simulation state of the robot.
+     * @param parent Parent object.
      */
-    void move(qreal delta, qreal distance) override;
+    explicit AutoRobot(RobotState state, QObject *parent = nullptr);
 
-    /**
-     * @brief Gets the speed of the robot. (pixels per second)
-     */
-    virtual qreal speed() override;
-
-    /**
-     * @brief Sets the speed of the robot. (pixels per second)
-     */
-    virtual void set_speed(qreal speed) override;
-
-    /**
-     * @brief Saves robot to the file
-     * @param file file to save robot into
-     */
-    virtual void save(std::ofstream &file) override;
 
     /**
      * @brief Gets the elide distance of the robot. (pixels)
@@ -115,14 +100,6 @@ public:
      * @brief Sets the rotation distance to avoid collision. (radians)
      */
     void set_rdist(qreal dist);
-
-private:
-    qreal sspeed;
-    qreal rot_remain;
-
-    qreal elide_dist;
-    qreal elide_rot;
-    qreal rot_speed;
 };
 
 } // namespace icp
@@ -0,0 +1,231 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Entry point of the micro-benchmarks of the geometry and collision
+ * functions.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "collision.hpp"
+#include "geometry.hpp"
+
+using namespace std;
+using namespace icp;
+
+/**
+ * @brief Number of the random inputs of each benchmark.
+ */
+constexpr size_t INPUT_COUNT = 4096;
+
+/**
+ * @brief Minimum time for which is each benchmark repeated.
+ */
+constexpr chrono::milliseconds MIN_TIME(200);
+
+/**
+ * @brief Seed of the random inputs, so that the results are reproducible.
+ */
+constexpr unsigned SEED = 42;
+
+/**
+ * @brief Results of the benchmarks are written here so that the compiler
+ * can't drop the computation.
+ */
+static volatile double sink;
+
+/**
+ * @brief Random inputs of the benchmarks.
+ */
+struct Inputs {
+    /** @brief Ray origins inside the room. */
+    vector<Vec2> points;
+    /** @brief Unit ray directions. */
+    vector<Vec2> dirs;
+    /** @brief Points on the second lines. */
+    vector<Vec2> others;
+    /** @brief Obstacles in the room. */
+    vector<Rect> rects;
+    /** @brief Robots near the obstacles, many of them overlap. */
+    vector<Rect> robots;
+    /**
+     * @brief Points inside the robots at the same indexes (corners, second
+     * robots).
+     */
+    vector<Vec2> corners;
+    /** @brief Packed edges of the obstacles. */
+    vector<double> lefts;
+    vector<double> tops;
+    vector<double> rights;
+    vector<double> bottoms;
+};
+
+/**
+ * @brief Generates the inputs of the benchmarks.
+ * @param seed Seed of the random generator.
+ */
+static Inputs generate(unsigned seed) {
+    constexpr double ROOM = 1000;
+    constexpr double DIAMETER = 30;
+
+    mt19937 rng(seed);
+    uniform_real_distribution<double> pos(0, ROOM);
+    uniform_real_distribution<double> size(10, 100);
+    uniform_real_distribution<double> angle(0, 2 * M_PI);
+    uniform_real_distribution<double> unit(0, 1);
+
+    Inputs in;
+    for (size_t i = 0; i < INPUT_COUNT; ++i) {
+        auto a = angle(rng);
+        in.points.push_back({ pos(rng), pos(rng) });
+        in.dirs.push_back({ cos(a), sin(a) });
+        in.others.push_back({ pos(rng), pos(rng) });
+
+        Rect r{ pos(rng), pos(rng), size(rng), size(rng) };
+        in.rects.push_back(r);
+        in.lefts.push_back(r.left());
+        in.tops.push_back(r.top());
+        in.rights.push_back(r.right());
+        in.bottoms.push_back(r.bottom());
+
+        // center of the robot anywhere up to its diameter around the
+        // obstacle
+        Vec2 c{
+            r.x - DIAMETER + unit(rng) * (r.w + 2 * DIAMETER),
+            r.y - DIAMETER + unit(rng) * (r.h + 2 * DIAMETER),
+        };
+        in.robots.push_back({
+            c.x - DIAMETER / 2, c.y - DIAMETER / 2, DIAMETER, DIAMETER
+        });
+
+        auto ca = angle(rng);
+        auto cd = unit(rng) * DIAMETER / 2;
+        in.corners.push_back({ c.x + cos(ca) * cd, c.y + sin(ca) * cd });
+    }
+
+    return in;
+}
+
+/**
+ * @brief Runs the benchmark and prints the average time of single operation.
+ * @param name Name of the benchmark.
+ * @param op Operation on the input with the given index. Its result is
+ * accumulated so that it isn't optimized out.
+ */
+template<typename F> static void bench(const char *name, F op) {
+    // warm up
+    double acc = 0;
+    for (size_t i = 0; i < INPUT_COUNT; ++i) {
+        acc += op(i);
+    }
+
+    size_t ops = 0;
+    auto start = chrono::steady_clock::now();
+    chrono::duration<double> elapsed;
+    do {
+        for (size_t i = 0; i < INPUT_COUNT; ++i) {
+            acc += op(i);
+        }
+        ops += INPUT_COUNT;
+        elapsed = chrono::steady_clock::now() - start;
+    } while (elapsed < MIN_TIME);
+
+    sink = acc;
+
+    cout << left << setw(24) << name << right << fixed << setprecision(2)
+        << setw(10) << elapsed.count() * 1e9 / ops << " ns/op" << endl;
+}
+
+/**
+ * @brief Prints the usage of the program.
+ * @param name Name of the program.
+ */
+static void print_help(const char *name) {
+    cerr << "Usage:" << endl
+        << "  " << name << " [filter]" << endl
+        << endl
+        << "Runs the micro-benchmarks of the geometry and collision"
+        << " functions on random" << endl
+        << "inputs with fixed seed and prints the time per operation. Only"
+        << " benchmarks" << endl
+        << "containing `filter` in their name are run." << endl;
+}
+
+int main(int argc, char **argv) {
+    const char *filter = "";
+    if (argc > 2) {
+        print_help(argv[0]);
+        return 1;
+    }
+    if (argc == 2) {
+        if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+            print_help(argv[0]);
+            return 0;
+        }
+        filter = argv[1];
+    }
+
+    auto in = generate(SEED);
+    auto run = [&](const char *name, auto op) {
+        if (strstr(name, filter)) {
+            bench(name, op);
+        }
+    };
+
+    run("segment_distance", [&](size_t i) {
+        auto &r = in.rects[i];
+        return segment_distance(
+            in.points[i], in.dirs[i], r.top_left(), r.bottom_right()
+        );
+    });
+
+    run("line_intersection", [&](size_t i) {
+        auto j = (i + 1) % INPUT_COUNT;
+        return line_intersection(
+            in.points[i], in.dirs[i], in.others[i], in.dirs[j]
+        ).x;
+    });
+
+    run("rect_distance", [&](size_t i) {
+        return rect_distance(in.points[i], in.dirs[i], in.rects[i]);
+    });
+
+    // the obstacles are tested in groups of 4 as leaves of the tree are
+    run("rect_distance_packed", [&](size_t i) {
+        auto j = i & ~size_t(3);
+        return rect_distance_packed(
+            in.points[i],
+            in.dirs[i],
+            &in.lefts[j],
+            &in.tops[j],
+            &in.rights[j],
+            &in.bottoms[j],
+            4
+        );
+    });
+
+    run("obstacle_collision", [&](size_t i) {
+        auto box = in.robots[i];
+        obstacle_collision(box, in.rects[i]);
+        return box.x + box.y;
+    });
+
+    run("corner_collision", [&](size_t i) {
+        auto box = in.robots[i];
+        corner_collision(box, in.corners[i]);
+        return box.x + box.y;
+    });
+
+    run("robot_collision", [&](size_t i) {
+        auto a = in.robots[i].top_left();
+        auto b = in.corners[i];
+        robot_collision(a, 15, b, 15);
+        return a.x + b.y;
+    });
+}
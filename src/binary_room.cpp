@@ -0,0 +1,203 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Binary format of the room file. (source file)
+ */
+
+#include "binary_room.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "little_endian.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/** @brief Identifies the binary room file. */
+static const char MAGIC[8] = { 'I', 'C', 'P', 'R', 'O', 'O', 'M', '\0' };
+
+constexpr size_t HEADER_SIZE = 48;
+constexpr size_t OBSTACLE_SIZE = 4 * 8;
+constexpr size_t ROBOT_SIZE = 8 + 8 * 8;
+/** @brief Size of robot in version 1 (without lidar). */
+constexpr size_t ROBOT_SIZE_V1 = 8 + 7 * 8;
+
+bool is_binary_room(const char *data, size_t size) {
+    return size >= sizeof(MAGIC) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool has_binary_room_ext(const string &filename) {
+    auto len = strlen(BINARY_ROOM_EXT);
+    return filename.size() >= len
+        && filename.compare(filename.size() - len, len, BINARY_ROOM_EXT) == 0;
+}
+
+World load_binary_room(
+    const char *data,
+    size_t size,
+    const Progress &progress
+) {
+    if (!is_binary_room(data, size)) {
+        throw runtime_error("Not a binary room file");
+    }
+    if (size < HEADER_SIZE) {
+        throw runtime_error("Truncated binary room file");
+    }
+
+    auto version = read_le<uint32_t>(data + 8);
+    if (version != BINARY_ROOM_VERSION && version != 1) {
+        throw runtime_error(
+            "Unsupported binary room version " + to_string(version)
+        );
+    }
+    auto robot_size = version == 1 ? ROBOT_SIZE_V1 : ROBOT_SIZE;
+
+    World world(read_le<double>(data + 16), read_le<double>(data + 24));
+    auto obstacles = read_le<uint64_t>(data + 32);
+    auto robots = read_le<uint64_t>(data + 40);
+
+    // compare by division so that invalid counts cannot overflow
+    auto rest = size - HEADER_SIZE;
+    if (obstacles > rest / OBSTACLE_SIZE
+        || robots > (rest - obstacles * OBSTACLE_SIZE) / robot_size
+        || rest != obstacles * OBSTACLE_SIZE + robots * robot_size)
+    {
+        throw runtime_error("Truncated binary room file");
+    }
+
+    double total = obstacles + robots;
+    auto report = [&](uint64_t done) {
+        if (progress && done % PROGRESS_STEP == 0) {
+            progress(done / total);
+        }
+    };
+
+    auto p = data + HEADER_SIZE;
+    for (uint64_t i = 0; i < obstacles; ++i, p += OBSTACLE_SIZE) {
+        report(i);
+        world.add_obstacle(ObstacleState{ Rect{
+            read_le<double>(p),
+            read_le<double>(p + 8),
+            read_le<double>(p + 16),
+            read_le<double>(p + 24),
+        } });
+    }
+
+    for (uint64_t i = 0; i < robots; ++i, p += robot_size) {
+        report(obstacles + i);
+        Vec2 pos{ read_le<double>(p + 8), read_le<double>(p + 16) };
+        auto angle = read_le<double>(p + 24);
+        auto speed = read_le<double>(p + 32);
+        auto rot_speed = read_le<double>(p + 40);
+
+        RobotState robot;
+        switch (read_le<uint32_t>(p)) {
+            case 0:
+                robot = RobotState::dummy(pos, angle, speed);
+                break;
+            case 1:
+                robot = RobotState::automatic(
+                    pos,
+                    angle,
+                    speed,
+                    read_le<double>(p + 48),
+                    read_le<double>(p + 56),
+                    rot_speed
+                );
+                break;
+            case 2:
+                robot = RobotState::controlled(pos, angle, speed, rot_speed);
+                break;
+            default:
+                throw runtime_error("Invalid robot kind in binary room file");
+        }
+
+        if (version != 1) {
+            robot.lidar_rays = read_le<uint32_t>(p + 4);
+            robot.lidar_fov = read_le<double>(p + 64);
+            if (robot.lidar_rays > MAX_LIDAR_RAYS) {
+                throw runtime_error("Invalid number of lidar rays");
+            }
+        }
+        world.add_robot(robot);
+    }
+
+    if (progress) {
+        progress(1);
+    }
+    return world;
+}
+
+/**
+ * @brief Writes the room in the binary room format.
+ */
+static void write_room(
+    ostream &out,
+    double width,
+    double height,
+    const vector<ObstacleState> &obstacles,
+    const RobotArrays &robots
+) {
+    vector<char> buf(
+        HEADER_SIZE
+            + obstacles.size() * OBSTACLE_SIZE
+            + robots.size() * ROBOT_SIZE,
+        0
+    );
+
+    memcpy(buf.data(), MAGIC, sizeof(MAGIC));
+    write_le<uint32_t>(buf.data() + 8, BINARY_ROOM_VERSION);
+    write_le<double>(buf.data() + 16, width);
+    write_le<double>(buf.data() + 24, height);
+    write_le<uint64_t>(buf.data() + 32, obstacles.size());
+    write_le<uint64_t>(buf.data() + 40, robots.size());
+
+    auto p = buf.data() + HEADER_SIZE;
+    for (auto &o : obstacles) {
+        write_le<double>(p, o.hitbox.x);
+        write_le<double>(p + 8, o.hitbox.y);
+        write_le<double>(p + 16, o.hitbox.w);
+        write_le<double>(p + 24, o.hitbox.h);
+        p += OBSTACLE_SIZE;
+    }
+
+    for (size_t i = 0; i < robots.size(); ++i, p += ROBOT_SIZE) {
+        auto r = robots.get(i);
+        write_le<uint32_t>(p, static_cast<uint32_t>(r.kind));
+        write_le<uint32_t>(p + 4, r.lidar_rays);
+        write_le<double>(p + 64, r.lidar_fov);
+        write_le<double>(p + 8, r.hitbox.x);
+        write_le<double>(p + 16, r.hitbox.y);
+        write_le<double>(p + 24, r.angle);
+        write_le<double>(p + 32, r.speed());
+        if (r.kind == RobotKind::Dummy) {
+            continue;
+        }
+        write_le<double>(p + 40, r.rot_speed);
+        if (r.kind == RobotKind::Auto) {
+            write_le<double>(p + 48, r.elide_dist);
+            write_le<double>(p + 56, r.elide_rot);
+        }
+    }
+
+    out.write(buf.data(), buf.size());
+}
+
+void save_binary_room(const World &world, ostream &out) {
+    write_room(
+        out,
+        world.width(),
+        world.height(),
+        world.obstacles(),
+        world.robots()
+    );
+}
+
+void save_binary_room(const WorldState &state, ostream &out) {
+    write_room(out, state.width, state.height, state.obstacles, state.robots);
+}
+
+} // namespace icp
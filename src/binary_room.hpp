@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Binary format of the room file. (header file)
+ *
+ * All the values are little-endian. The file starts with header:
+ *  - magic `ICPROOM` followed by zero byte (8 bytes)
+ *  - version (u32), currently `BINARY_ROOM_VERSION`
+ *  - reserved (u32), zero
+ *  - width and height of the room (f64 each), 0x0 if it isn't specified
+ *  - number of obstacles (u64)
+ *  - number of robots (u64)
+ *
+ * Then there are the obstacles, each of them is x, y, width and height of
+ * its hitbox (f64 each). After them there are the robots, each of them is:
+ *  - kind (u32): 0 for `Dummy`, 1 for `Auto`, 2 for `Control`
+ *  - number of the rays of the lidar (u32), 0 if the robot has none
+ *  - x and y of the top-left corner of the hitbox (f64 each)
+ *  - angle in radians (f64)
+ *  - speed in pixels per second (f64)
+ *  - rotation speed in radians per second (f64)
+ *  - elide distance in pixels (f64)
+ *  - elide rotation in radians (f64)
+ *  - angle covered by the lidar in radians (f64)
+ *
+ * The values that the kind of the robot doesn't use are zero. Version 1
+ * files have the robots without the lidar (the number of rays is reserved
+ * zero and the angle is missing), they can be still loaded.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "world.hpp"
+
+namespace icp {
+
+/**
+ * @brief Version of the binary room format written by `save_binary_room`.
+ */
+constexpr std::uint32_t BINARY_ROOM_VERSION = 2;
+
+/**
+ * @brief Extension of files that are saved in the binary format.
+ */
+constexpr const char *BINARY_ROOM_EXT = ".bin";
+
+/**
+ * @brief Checks whether the data start with the header of the binary room
+ * format.
+ */
+bool is_binary_room(const char *data, std::size_t size);
+
+/**
+ * @brief Checks whether the file should be saved in the binary format
+ * (based on its extension).
+ */
+bool has_binary_room_ext(const std::string &filename);
+
+/**
+ * @brief Loads the world from the binary room format.
+ * @param data Contents of the file.
+ * @param size Size of the contents in bytes.
+ * @param progress Called from time to time during the load.
+ * @throws std::runtime_error when the data are not valid.
+ */
+World load_binary_room(
+    const char *data,
+    std::size_t size,
+    const Progress &progress = Progress()
+);
+
+/**
+ * @brief Saves the world in the binary room format.
+ * @param world World to save.
+ * @param out Stream to write to (it should be opened in binary mode).
+ */
+void save_binary_room(const World &world, std::ostream &out);
+
+/**
+ * @brief Saves the captured state in the binary room format.
+ * @param state State to save.
+ * @param out Stream to write to (it should be opened in binary mode).
+ */
+void save_binary_room(const WorldState &state, std::ostream &out);
+
+} // namespace icp
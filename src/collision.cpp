@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Resolution of the collisions of robots with obstacles and with each
+ * other. (source file)
+ */
+
+#include "collision.hpp"
+
+#include <cmath>
+
+namespace icp {
+
+using namespace std;
+
+void obstacle_collision(Rect &c, Rect r) {
+    // `c` is hitbox of circle (robot)
+    // `r` is rectangle (obstacle)
+
+    // check edge overlap
+    auto center = c.center();
+    auto cx = center.x;
+    auto cy = center.y;
+    // horizontal edge
+    if (in_range(cx, r.left(), r.right())) {
+        // top edge of obstacle
+        if (in_range(c.bottom(), r.top(), r.bottom())) {
+            c.move_bottom(r.top());
+            return;
+        }
+        // bottom edge of obstacle
+        if (in_range(c.top(), r.top(), r.bottom())) {
+            c.move_top(r.bottom());
+            return;
+        }
+        // no overlap
+        return;
+    } else if (in_range(cy, r.top(), r.bottom())) {
+        // left edge of obstacle
+        if (in_range(c.right(), r.left(), r.right())) {
+            c.move_right(r.left());
+            return;
+        }
+        // right edge of obstacle
+        if (in_range(c.left(), r.left(), r.right())) {
+            c.move_left(r.right());
+            return;
+        }
+        // no overlap
+        return;
+    }
+
+    // check corner overlap
+    auto radius = c.w / 2;
+    if (in_circle(radius, center, r.top_left())) {
+        corner_collision(c, r.top_left());
+        return;
+    }
+    if (in_circle(radius, center, r.top_right())) {
+        corner_collision(c, r.top_right());
+        return;
+    }
+    if (in_circle(radius, center, r.bottom_right())) {
+        corner_collision(c, r.bottom_right());
+        return;
+    }
+    if (in_circle(radius, center, r.bottom_left())) {
+        corner_collision(c, r.bottom_left());
+        return;
+    }
+}
+
+void corner_collision(Rect &box, Vec2 p) {
+    auto c = box.center();
+    auto r = box.w / 2;
+
+    auto mv = p - c;
+    auto ml = sqrt(mv.x * mv.x + mv.y * mv.y);
+    if (ml == 0) {
+        // center exactly on the corner, there is no direction to push to
+        return;
+    }
+    mv = mv - mv * (r / ml);
+
+    box.move_top_left(box.top_left() + mv);
+}
+
+bool robot_collision(Vec2 &a, double ra, Vec2 &b, double rb) {
+    Vec2 dir;
+    if (!robot_push(a, ra, b, rb, dir)) {
+        return false;
+    }
+
+    a -= dir;
+    b += dir;
+    return true;
+}
+
+bool robot_push(Vec2 a, double ra, Vec2 b, double rb, Vec2 &push) {
+    auto dir = b - a;
+    auto cw = ra + rb;
+    auto dir_len = sqrt(dir.x * dir.x + dir.y * dir.y);
+    auto over = cw - dir_len;
+
+    if (over <= 0) {
+        // No collision
+        return false;
+    }
+
+    push = dir_len == 0 ? Vec2{ 0, 0 } : dir * (over / (2 * dir_len));
+    return true;
+}
+
+} // namespace icp
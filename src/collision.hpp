@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Resolution of the collisions of robots with obstacles and with each
+ * other. (header file)
+ */
+
+#pragma once
+
+#include "geometry.hpp"
+
+namespace icp {
+
+/**
+ * @brief Pushes the robot out of the obstacle if they overlap.
+ * @param robot Hitbox of the robot (circle), it is moved.
+ * @param obstacle Hitbox of the obstacle.
+ */
+void obstacle_collision(Rect &robot, Rect obstacle);
+
+/**
+ * @brief Pushes the robot so that the point is on its circumference.
+ * @param robot Hitbox of the robot (circle) that contains the point, it is
+ * moved.
+ * @param p Point inside the robot (corner of obstacle).
+ */
+void corner_collision(Rect &robot, Vec2 p);
+
+/**
+ * @brief Pushes two robots apart if they overlap. Both are moved by half of
+ * the overlap.
+ * @param a Top-left corner of the hitbox of the first robot.
+ * @param ra Radius of the first robot.
+ * @param b Top-left corner of the hitbox of the second robot.
+ * @param rb Radius of the second robot.
+ * @return true if the robots overlapped and were moved, otherwise false.
+ */
+bool robot_collision(Vec2 &a, double ra, Vec2 &b, double rb);
+
+/**
+ * @brief Calculates how much are two robots pushed apart if they overlap
+ * (the same as `robot_collision` without moving them).
+ * @param a Top-left corner of the hitbox of the first robot.
+ * @param ra Radius of the first robot.
+ * @param b Top-left corner of the hitbox of the second robot.
+ * @param rb Radius of the second robot.
+ * @param push Set to the move of the second robot, the first robot is moved
+ * in the opposite direction.
+ * @return true if the robots overlap, otherwise false.
+ */
+bool robot_push(Vec2 a, double ra, Vec2 b, double rb, Vec2 &push);
+
+} // namespace icp
@@ -37,102 +37,70 @@ ControlRobot::ControlRobot(
     qreal speed,
     qreal rot_speed,
     QObject *parent
-) : Robot(position, angle, 0, parent),
-    sspeed(speed),
-    rot_speed(rot_speed),
-    cur_speed(0),
-    cur_rot_speed(0)
-{
+) : Robot(
+    position,
+    RobotState::controlled(Vec2{ 0, 0 }, angle, speed, rot_speed),
+    parent
+) {
     setBrush(QBrush(QColor(0x55, 0xcc, 0x55)));
 }
 
-ControlRobot::ControlRobot(Robot *r) :
-    Robot(r),
-    sspeed(r->speed()),
-    rot_speed(M_PI / M_E),
-    cur_speed(0),
-    cur_rot_speed(0)
+ControlRobot::ControlRobot(RobotState state, QObject *parent) :
+    Robot(state, parent)
 {
     setBrush(QBrush(QColor(0x55, 0xcc, 0x55)));
+}
+
+ControlRobot::ControlRobot(Robot *r) : Robot(r) {
+    setBrush(QBrush(QColor(0x55, 0xcc, 0x55)));
+
+    rstate.kind = RobotKind::Control;
+    rstate.sspeed = r->speed();
+    rstate.rot_speed = M_PI / M_E;
+    rstate.cur_speed = 0;
+    rstate.cur_rot_speed = 0;
 
     auto arob = dynamic_cast<AutoRobot *>(r);
     if (arob) {
-        rot_speed = arob->rspeed();
+        rstate.rot_speed = arob->rspeed();
     }
 
     auto crob = dynamic_cast<ControlRobot *>(r);
     if (crob) {
-        rot_speed = crob->rspeed();
-    }
-}
-
-void ControlRobot::move(qreal delta, qreal distance) {
-    if (distance == 0) {
-        sspeed = Robot::speed();
-        Robot::set_speed(0);
-    } else {
-        Robot::set_speed(cur_speed);
-    }
-
-    if (cur_rot_speed != 0) {
-        auto ang = cur_rot_speed * delta;
-        Robot::set_angle(orientation() + ang);
-    }
-
-    Robot::move(delta, distance);
-}
-
-qreal ControlRobot::speed() {
-    if (cur_speed == 0) {
-        return sspeed;
-    }
-    return Robot::speed();
-}
-
-void ControlRobot::set_speed(qreal speed) {
-    if (cur_speed == 0) {
-        sspeed = speed;
-    }
-    Robot::set_speed(speed);
-}
-
-void ControlRobot::save(ofstream &file) {
-    auto ang = get_mod_angle(360);
-    if (ang < -180) {
-        ang += 360;
+        rstate.rot_speed = crob->rspeed();
     }
-
-    file << "control_robot: [" << hitbox().x() << ", " << hitbox().y()
-        << "] { speed: " << speed() << ", rotation_speed: "
-        << rot_speed / M_PI * 180 << ", angle: " << ang << " }" << endl;
 }
 
 qreal ControlRobot::rspeed() const {
-    return rot_speed;
+    return rstate.rot_speed;
 }
 
 void ControlRobot::set_rspeed(qreal speed) {
-    rot_speed = speed;
+    rstate.rot_speed = speed;
+    commit_params();
 }
 
 void ControlRobot::forward(bool start) {
-    cur_speed = start ? sspeed : 0;
+    rstate.cur_speed = start ? rstate.sspeed : 0;
+    commit_params();
 }
 
 void ControlRobot::right(bool start) {
     if (start) {
-        cur_rot_speed += rot_speed;
+        rstate.cur_rot_speed += rstate.rot_speed;
     } else {
-        cur_rot_speed -= rot_speed;
+        rstate.cur_rot_speed -= rstate.rot_speed;
     }
+    commit_params();
 }
 
 void ControlRobot::left(bool start) {
     if (start) {
-        cur_rot_speed -= rot_speed;
+        rstate.cur_rot_speed -= rstate.rot_speed;
     } else {
-        cur_rot_speed += rot_speed;
+        rstate.cur_rot_speed += rstate.rot_speed;
     }
+    commit_params();
 }
 
 } // namespace icp
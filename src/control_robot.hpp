@@ -52,23 +52,12 @@ public:
     explicit ControlRobot(Robot *r);
 
     /**
-     * @brief Moves the robot.
-     * @param delta How much time (in second) passed since the last tick.
-     * @param distance Distance to the closest obstacle in front of the robot.
+     * @brief Creates the robot from its simulation state.
+     * @param state The simulation state of the robot.
+     * @param parent Parent object.
      */
-    void move(qreal delta, qreal distance) override;
+    explicit ControlRobot(RobotState state, QObject *parent = nullptr);
 
-    /**
-     * @brief Gets the movement speed of the robot. (pixels per second)
-     */
-    virtual qreal speed() override;
-
-    /**
-     * @brief Sets the movement speed of the robot. (pixels per second)
-     */
-    virtual void set_speed(qreal speed) override;
-
-    virtual void save(std::ofstream &file) override;
 
     /**
      * @brief Gets rotation speed of the robot
@@ -95,13 +84,6 @@ public:
      * @brief Starts rotating robot right
      */
     void right(bool start = true);
-
-private:
-    qreal sspeed;
-    qreal rot_speed;
-
-    qreal cur_speed;
-    qreal cur_rot_speed;
 };
 
 } // namespace icp
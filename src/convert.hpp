@@ -0,0 +1,44 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Conversions between the Qt and the simulation geometry types.
+ */
+
+#pragma once
+
+#include <QPointF>
+#include <QRectF>
+
+#include "geometry.hpp"
+
+namespace icp {
+
+/**
+ * @brief Converts Qt point to simulation vector.
+ */
+inline Vec2 to_vec(QPointF p) {
+    return { p.x(), p.y() };
+}
+
+/**
+ * @brief Converts simulation vector to Qt point.
+ */
+inline QPointF to_qpoint(Vec2 v) {
+    return QPointF(v.x, v.y);
+}
+
+/**
+ * @brief Converts Qt rectangle to simulation rectangle.
+ */
+inline Rect to_rect(const QRectF &r) {
+    return { r.x(), r.y(), r.width(), r.height() };
+}
+
+/**
+ * @brief Converts simulation rectangle to Qt rectangle.
+ */
+inline QRectF to_qrect(Rect r) {
+    return QRectF(r.x, r.y, r.w, r.h);
+}
+
+} // namespace icp
@@ -0,0 +1,279 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Precomputed distances to the obstacles for sphere tracing. (source
+ * file)
+ */
+
+#include "distance_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace icp {
+
+using namespace std;
+
+/**
+ * @brief Distances are stored in units of this part of a cell.
+ */
+constexpr double UNITS_PER_CELL = 8;
+
+/**
+ * @brief The largest stored distance in units.
+ */
+constexpr double MAX_UNITS = UINT8_MAX;
+
+/**
+ * @brief The largest stored distance in cells (rounded up).
+ */
+constexpr size_t MAX_CELLS_DIST = MAX_UNITS / UNITS_PER_CELL + 1;
+
+/**
+ * @brief Squared distance in cells of the cells without any edge. It is
+ * larger than any stored distance.
+ */
+constexpr double FAR = 1e6;
+
+/**
+ * @brief Calculates `min(f[j] + (i - j)^2)` over all `j` for each `i`
+ * (distance transform of sampled function by Felzenszwalb and Huttenlocher).
+ * @param f Values at the positions.
+ * @param res The results.
+ * @param n Number of positions.
+ * @param v Buffer for `n` values.
+ * @param z Buffer for `n + 1` values.
+ */
+static void distance_transform(
+    const double *f,
+    double *res,
+    size_t n,
+    size_t *v,
+    double *z
+) {
+    // lower envelope of the parabolas rooted at the positions
+    auto intersection = [&](size_t q, size_t r) {
+        return (f[q] + double(q) * q - f[r] - double(r) * r)
+            / (2. * q - 2. * r);
+    };
+
+    size_t k = 0;
+    v[0] = 0;
+    z[0] = -INFINITY;
+    z[1] = INFINITY;
+    for (size_t q = 1; q < n; ++q) {
+        auto s = intersection(q, v[k]);
+        while (s <= z[k]) {
+            --k;
+            s = intersection(q, v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = INFINITY;
+    }
+
+    k = 0;
+    for (size_t q = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        auto dq = double(q) - double(v[k]);
+        res[q] = dq * dq + f[v[k]];
+    }
+}
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+DistanceField::DistanceField() :
+    unit(1),
+    dists(),
+    dirty{ 0, 0, -1, -1 },
+    sq(),
+    line(),
+    envelope(),
+    bounds()
+{}
+
+void DistanceField::build(const ObstacleGrid &grid) {
+    unit = grid.cell_size() / UNITS_PER_CELL;
+    dists.assign(grid.cols() * grid.rows(), 0);
+    dirty = Rect{ 0, 0, -1, -1 };
+    bake(grid, 0, 0, grid.cols(), grid.rows());
+}
+
+void DistanceField::changed(const ObstacleGrid &grid, Rect area) {
+    if (dirty.w < 0) {
+        dirty = area;
+        return;
+    }
+
+    // distant changes are recomputed separately, so that the cells between
+    // them are not
+    auto margin = 2 * MAX_CELLS_DIST * grid.cell_size();
+    if (area.right() + margin < dirty.left()
+        || dirty.right() + margin < area.left()
+        || area.bottom() + margin < dirty.top()
+        || dirty.bottom() + margin < area.top()
+    ) {
+        update(grid);
+        dirty = area;
+        return;
+    }
+
+    auto l = min(dirty.left(), area.left());
+    auto t = min(dirty.top(), area.top());
+    auto r = max(dirty.right(), area.right());
+    auto b = max(dirty.bottom(), area.bottom());
+    dirty = Rect{ l, t, r - l, b - t };
+}
+
+void DistanceField::update(const ObstacleGrid &grid) {
+    if (dirty.w < 0) {
+        return;
+    }
+
+    // only the cells that have the largest distance both before and after
+    // are not affected
+    auto cols = grid.cols();
+    auto rows = grid.rows();
+    auto cell = [&](double v, size_t count) {
+        return size_t(clamp(floor(v / grid.cell_size()), 0., double(count)));
+    };
+    auto x0 = cell(dirty.left(), cols);
+    auto y0 = cell(dirty.top(), rows);
+    auto x1 = cell(dirty.right(), cols - 1) + 1;
+    auto y1 = cell(dirty.bottom(), rows - 1) + 1;
+    bake(
+        grid,
+        x0 > MAX_CELLS_DIST ? x0 - MAX_CELLS_DIST : 0,
+        y0 > MAX_CELLS_DIST ? y0 - MAX_CELLS_DIST : 0,
+        min(x1 + MAX_CELLS_DIST, cols),
+        min(y1 + MAX_CELLS_DIST, rows)
+    );
+    dirty = Rect{ 0, 0, -1, -1 };
+}
+
+double DistanceField::ray_distance(
+    const ObstacleGrid &grid,
+    const ObstacleTree &tree,
+    Vec2 p,
+    Vec2 d,
+    double max
+) const {
+    ObstacleGrid::Ray ray{ p, d, 0, 0, 0 };
+    auto best = max;
+    // the cell at `ray.t` is found again after each skip
+    auto skipped = true;
+
+    while (ray.t < best) {
+        if (skipped) {
+            if (!grid.find_cell(ray)) {
+                auto t = ray.t;
+                return t + tree.ray_distance(p + d * t, d, best - t);
+            }
+            skipped = false;
+        }
+
+        // no edge is closer than `step` to any point in the cell
+        double step = dists[ray.y * grid.cols() + ray.x] * unit;
+        if (step >= grid.cell_size()) {
+            ray.t += step;
+            skipped = true;
+            continue;
+        }
+
+        // close to an edge, test the edges in the cell and move to the next
+        // cell along the 'ray'
+        best = grid.test_cell(ray, best);
+        if (!grid.next_cell(ray) && ray.t < best) {
+            // the rest of the 'ray' is outside of the room
+            auto t = ray.t;
+            return t + tree.ray_distance(p + d * t, d, best - t);
+        }
+    }
+
+    return best;
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+void DistanceField::bake(
+    const ObstacleGrid &grid,
+    size_t x0,
+    size_t y0,
+    size_t x1,
+    size_t y1
+) {
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    auto cols = grid.cols();
+    auto rows = grid.rows();
+
+    // edges farther than the largest distance don't matter
+    auto wx0 = x0 > MAX_CELLS_DIST ? x0 - MAX_CELLS_DIST : 0;
+    auto wy0 = y0 > MAX_CELLS_DIST ? y0 - MAX_CELLS_DIST : 0;
+    auto wx1 = min(x1 + MAX_CELLS_DIST, cols);
+    auto wy1 = min(y1 + MAX_CELLS_DIST, rows);
+    auto w = wx1 - wx0;
+    auto h = wy1 - wy0;
+
+    // The distance of two cells is the distance of the closest points of
+    // their squares, that is the distance of their indexes decreased by one
+    // in each axis. With the neighbours of the cells with edges marked too,
+    // it is the plain distance to the closest marked index.
+    sq.assign(w * h, FAR);
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < w; ++x) {
+            if (!grid.has_edges((wy0 + y) * cols + wx0 + x)) {
+                continue;
+            }
+            auto ny1 = min(y + 1, h - 1);
+            auto nx1 = min(x + 1, w - 1);
+            for (auto ny = y ? y - 1 : 0; ny <= ny1; ++ny) {
+                for (auto nx = x ? x - 1 : 0; nx <= nx1; ++nx) {
+                    sq[ny * w + nx] = 0;
+                }
+            }
+        }
+    }
+
+    // squared distances to the marked cells, by columns and then by rows
+    auto n = max(w, h);
+    line.resize(2 * n);
+    envelope.resize(n);
+    bounds.resize(n + 1);
+    auto f = line.data();
+    auto res = line.data() + n;
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            f[y] = sq[y * w + x];
+        }
+        distance_transform(f, res, h, envelope.data(), bounds.data());
+        for (size_t y = 0; y < h; ++y) {
+            sq[y * w + x] = res[y];
+        }
+    }
+    for (auto y = y0 - wy0; y < y1 - wy0; ++y) {
+        auto row = sq.data() + y * w;
+        distance_transform(row, res, w, envelope.data(), bounds.data());
+        copy(res, res + w, row);
+    }
+
+    for (auto y = y0; y < y1; ++y) {
+        for (auto x = x0; x < x1; ++x) {
+            // round down so that the distance is never overestimated
+            auto u = sqrt(sq[(y - wy0) * w + x - wx0]) * UNITS_PER_CELL;
+            dists[y * cols + x] = min(floor(u), MAX_UNITS);
+        }
+    }
+}
+
+} // namespace icp
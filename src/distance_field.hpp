@@ -0,0 +1,100 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Precomputed distances to the obstacles for sphere tracing. (header
+ * file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry.hpp"
+#include "obstacle_grid.hpp"
+#include "obstacle_tree.hpp"
+
+namespace icp {
+
+/**
+ * @brief Distances from the cells of `ObstacleGrid` to the closest cell
+ * crossed by an edge. Any point in the cell is at least that far from all the
+ * edges, so a 'ray' can skip that part without walking the cells (sphere
+ * tracing). Near the edges the 'ray' walks the cells of the grid one by one.
+ */
+class DistanceField {
+public:
+    /**
+     * @brief Creates empty field.
+     */
+    DistanceField();
+
+    /**
+     * @brief Computes the distances of all the cells of the grid.
+     * @param grid Grid with the obstacles.
+     */
+    void build(const ObstacleGrid &grid);
+
+    /**
+     * @brief Marks area where obstacle was added to or removed from the grid.
+     * The distances are recomputed by `update`.
+     * @param grid Grid with the obstacles (after the change).
+     * @param area Hitbox of the obstacle.
+     */
+    void changed(const ObstacleGrid &grid, Rect area);
+
+    /**
+     * @brief Recomputes the distances of the cells near the changes since
+     * the last update (all the changes at once, so moving an obstacle
+     * recomputes the cells around it only once).
+     * @param grid Grid with the obstacles.
+     */
+    void update(const ObstacleGrid &grid);
+
+    /**
+     * @brief Calculates the distance of the closest obstacle from a point in
+     * the given direction. The result is the same as with
+     * `ObstacleTree::ray_distance` up to rounding.
+     * @param grid Grid from which the field was built.
+     * @param tree Tree built from the same obstacles. It is used only for
+     * points outside of the room.
+     * @param p Point from which to calculate the distance.
+     * @param d Unit direction from the point ('ray').
+     * @param max Only obstacles closer than this are considered.
+     * @return The distance. `max` if no obstacle is closer.
+     */
+    double ray_distance(
+        const ObstacleGrid &grid,
+        const ObstacleTree &tree,
+        Vec2 p,
+        Vec2 d,
+        double max
+    ) const;
+
+private:
+    // recomputes the distances of the cells in the columns [x0, x1) and rows
+    // [y0, y1)
+    void bake(
+        const ObstacleGrid &grid,
+        std::size_t x0,
+        std::size_t y0,
+        std::size_t x1,
+        std::size_t y1
+    );
+
+    /** @brief Unit of the stored distances. */
+    double unit;
+    /** @brief Distances of the cells in `unit`s, rounded down. */
+    std::vector<std::uint8_t> dists;
+    /** @brief Bounds of the changes since the last update (empty if w < 0). */
+    Rect dirty;
+
+    // reused buffers for `bake`
+    std::vector<double> sq;
+    std::vector<double> line;
+    std::vector<std::size_t> envelope;
+    std::vector<double> bounds;
+};
+
+} // namespace icp
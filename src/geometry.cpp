@@ -0,0 +1,268 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Qt independent geometry primitives used by the simulation.
+ * (source file)
+ */
+
+#include "geometry.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace icp {
+
+using namespace std;
+
+/**
+ * @brief Calculates the distance of a rectangle from a point in the given
+ * direction using the slab method.
+ * @param p Point from which to calculate the distance.
+ * @param d Direction from the point ('ray').
+ * @param inv Inverse of the direction.
+ * @return Distance from the rectangle. INFINITY if the 'ray' doesn't touch the
+ * rectangle.
+ */
+static double slab_distance(
+    Vec2 p,
+    Vec2 d,
+    Vec2 inv,
+    double l,
+    double t,
+    double r,
+    double b
+) {
+    double tmin = -INFINITY;
+    double tmax = INFINITY;
+
+    if (d.x != 0) {
+        auto t1 = (l - p.x) * inv.x;
+        auto t2 = (r - p.x) * inv.x;
+        tmin = min(t1, t2);
+        tmax = max(t1, t2);
+    } else if (!in_range(p.x, l, r)) {
+        return INFINITY;
+    }
+
+    if (d.y != 0) {
+        auto t1 = (t - p.y) * inv.y;
+        auto t2 = (b - p.y) * inv.y;
+        tmin = max(tmin, min(t1, t2));
+        tmax = min(tmax, max(t1, t2));
+    } else if (!in_range(p.y, t, b)) {
+        return INFINITY;
+    }
+
+    if (tmax < tmin || tmax < 0) {
+        return INFINITY;
+    }
+    // when the point is inside, the distance is to the exit
+    return tmin > 0 ? tmin : tmax;
+}
+
+bool in_range(double val, double start, double end) {
+    return val > start && val < end;
+}
+
+bool in_circle(double radius, Vec2 center, Vec2 point) {
+    auto dist = center - point;
+    return dist.x * dist.x + dist.y * dist.y < radius * radius;
+}
+
+double cross(Vec2 a, Vec2 b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+Vec2 line_intersection(Vec2 p1, Vec2 d1, Vec2 p2, Vec2 d2) {
+    auto u = cross(p2 - p1, d1) / cross(d1, d2);
+    return p2 + d2 * u;
+}
+
+double segment_distance(Vec2 p, Vec2 d, Vec2 a, Vec2 b) {
+    auto is = line_intersection(p, d, a, a - b);
+    if (isnan(is.x)
+        || isnan(is.y)
+        || (!in_range(is.x, a.x, b.x) && !in_range(is.y, a.y, b.y))
+    ) {
+        return INFINITY;
+    }
+    auto v = is - p;
+    if (Vec2::dot(d, v) < 0) {
+        return INFINITY;
+    }
+
+    return sqrt(v.x * v.x + v.y * v.y);
+}
+
+double rect_distance(Vec2 p, Vec2 d, Rect r) {
+    return min({
+        segment_distance(p, d, r.top_left(), r.top_right()),
+        segment_distance(p, d, r.top_right(), r.bottom_right()),
+        segment_distance(p, d, r.bottom_left(), r.bottom_right()),
+        segment_distance(p, d, r.top_left(), r.bottom_left())
+    });
+}
+
+double circle_distance(Vec2 p, Vec2 d, Vec2 c, double r) {
+    auto v = c - p;
+    auto b = Vec2::dot(v, d);
+    auto outside = Vec2::dot(v, v) - r * r;
+    if (b <= 0) {
+        return INFINITY;
+    }
+    if (outside <= 0) {
+        return 0;
+    }
+
+    auto disc = b * b - outside;
+    return disc < 0 ? INFINITY : b - sqrt(disc);
+}
+
+double rect_distance_packed(
+    Vec2 p,
+    Vec2 d,
+    const double *left,
+    const double *top,
+    const double *right,
+    const double *bottom,
+    size_t n
+) {
+    Vec2 inv{ 1 / d.x, 1 / d.y };
+    double res = INFINITY;
+    size_t i = 0;
+
+#if defined(__AVX__)
+    // the same as `slab_distance` for 4 rectangles at once
+    auto px = _mm256_set1_pd(p.x);
+    auto py = _mm256_set1_pd(p.y);
+    auto ix = _mm256_set1_pd(inv.x);
+    auto iy = _mm256_set1_pd(inv.y);
+    auto zero = _mm256_setzero_pd();
+    auto inf = _mm256_set1_pd(INFINITY);
+    auto acc = inf;
+    for (; i + 4 <= n; i += 4) {
+        auto l = _mm256_loadu_pd(left + i);
+        auto t = _mm256_loadu_pd(top + i);
+        auto r = _mm256_loadu_pd(right + i);
+        auto b = _mm256_loadu_pd(bottom + i);
+
+        auto tmin = _mm256_set1_pd(-INFINITY);
+        auto tmax = inf;
+        auto hit = _mm256_cmp_pd(zero, zero, _CMP_EQ_OQ);
+
+        if (d.x != 0) {
+            auto t1 = _mm256_mul_pd(_mm256_sub_pd(l, px), ix);
+            auto t2 = _mm256_mul_pd(_mm256_sub_pd(r, px), ix);
+            tmin = _mm256_min_pd(t1, t2);
+            tmax = _mm256_max_pd(t1, t2);
+        } else {
+            hit = _mm256_and_pd(hit, _mm256_and_pd(
+                _mm256_cmp_pd(px, l, _CMP_GT_OQ),
+                _mm256_cmp_pd(px, r, _CMP_LT_OQ)
+            ));
+        }
+
+        if (d.y != 0) {
+            auto t1 = _mm256_mul_pd(_mm256_sub_pd(t, py), iy);
+            auto t2 = _mm256_mul_pd(_mm256_sub_pd(b, py), iy);
+            tmin = _mm256_max_pd(tmin, _mm256_min_pd(t1, t2));
+            tmax = _mm256_min_pd(tmax, _mm256_max_pd(t1, t2));
+        } else {
+            hit = _mm256_and_pd(hit, _mm256_and_pd(
+                _mm256_cmp_pd(py, t, _CMP_GT_OQ),
+                _mm256_cmp_pd(py, b, _CMP_LT_OQ)
+            ));
+        }
+
+        hit = _mm256_and_pd(hit, _mm256_and_pd(
+            _mm256_cmp_pd(tmax, tmin, _CMP_GE_OQ),
+            _mm256_cmp_pd(tmax, zero, _CMP_GE_OQ)
+        ));
+        auto dist = _mm256_blendv_pd(
+            tmax,
+            tmin,
+            _mm256_cmp_pd(tmin, zero, _CMP_GT_OQ)
+        );
+        acc = _mm256_min_pd(acc, _mm256_blendv_pd(inf, dist, hit));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    res = min({ lanes[0], lanes[1], lanes[2], lanes[3] });
+#elif defined(__SSE2__)
+    // the same as `slab_distance` for 2 rectangles at once
+    auto px = _mm_set1_pd(p.x);
+    auto py = _mm_set1_pd(p.y);
+    auto ix = _mm_set1_pd(inv.x);
+    auto iy = _mm_set1_pd(inv.y);
+    auto zero = _mm_setzero_pd();
+    auto inf = _mm_set1_pd(INFINITY);
+    auto acc = inf;
+    for (; i + 2 <= n; i += 2) {
+        auto l = _mm_loadu_pd(left + i);
+        auto t = _mm_loadu_pd(top + i);
+        auto r = _mm_loadu_pd(right + i);
+        auto b = _mm_loadu_pd(bottom + i);
+
+        auto tmin = _mm_set1_pd(-INFINITY);
+        auto tmax = inf;
+        auto hit = _mm_cmpeq_pd(zero, zero);
+
+        if (d.x != 0) {
+            auto t1 = _mm_mul_pd(_mm_sub_pd(l, px), ix);
+            auto t2 = _mm_mul_pd(_mm_sub_pd(r, px), ix);
+            tmin = _mm_min_pd(t1, t2);
+            tmax = _mm_max_pd(t1, t2);
+        } else {
+            hit = _mm_and_pd(
+                hit,
+                _mm_and_pd(_mm_cmpgt_pd(px, l), _mm_cmplt_pd(px, r))
+            );
+        }
+
+        if (d.y != 0) {
+            auto t1 = _mm_mul_pd(_mm_sub_pd(t, py), iy);
+            auto t2 = _mm_mul_pd(_mm_sub_pd(b, py), iy);
+            tmin = _mm_max_pd(tmin, _mm_min_pd(t1, t2));
+            tmax = _mm_min_pd(tmax, _mm_max_pd(t1, t2));
+        } else {
+            hit = _mm_and_pd(
+                hit,
+                _mm_and_pd(_mm_cmpgt_pd(py, t), _mm_cmplt_pd(py, b))
+            );
+        }
+
+        hit = _mm_and_pd(
+            hit,
+            _mm_and_pd(_mm_cmpge_pd(tmax, tmin), _mm_cmpge_pd(tmax, zero))
+        );
+        // SSE2 has no blend, select with masks
+        auto front = _mm_cmpgt_pd(tmin, zero);
+        auto dist = _mm_or_pd(
+            _mm_and_pd(front, tmin),
+            _mm_andnot_pd(front, tmax)
+        );
+        dist = _mm_or_pd(_mm_and_pd(hit, dist), _mm_andnot_pd(hit, inf));
+        acc = _mm_min_pd(acc, dist);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    res = min(lanes[0], lanes[1]);
+#endif
+
+    for (; i < n; ++i) {
+        res = min(
+            res,
+            slab_distance(p, d, inv, left[i], top[i], right[i], bottom[i])
+        );
+    }
+
+    return res;
+}
+
+} // namespace icp
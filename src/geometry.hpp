@@ -0,0 +1,161 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Qt independent geometry primitives used by the simulation.
+ * (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace icp {
+
+/**
+ * @brief 2D vector (or point).
+ */
+struct Vec2 {
+    double x;
+    double y;
+
+    constexpr Vec2 operator+(Vec2 o) const { return { x + o.x, y + o.y }; }
+    constexpr Vec2 operator-(Vec2 o) const { return { x - o.x, y - o.y }; }
+    constexpr Vec2 operator*(double s) const { return { x * s, y * s }; }
+    constexpr Vec2 operator/(double s) const { return { x / s, y / s }; }
+
+    constexpr Vec2 &operator+=(Vec2 o) { return *this = *this + o; }
+    constexpr Vec2 &operator-=(Vec2 o) { return *this = *this - o; }
+
+    /**
+     * @brief Calculates the dot product of two vectors.
+     */
+    static constexpr double dot(Vec2 a, Vec2 b) {
+        return a.x * b.x + a.y * b.y;
+    }
+};
+
+/**
+ * @brief Axis aligned rectangle. The semantics of the methods match those of
+ * `QRectF`.
+ */
+struct Rect {
+    double x;
+    double y;
+    double w;
+    double h;
+
+    constexpr double left() const { return x; }
+    constexpr double top() const { return y; }
+    constexpr double right() const { return x + w; }
+    constexpr double bottom() const { return y + h; }
+
+    constexpr Vec2 top_left() const { return { left(), top() }; }
+    constexpr Vec2 top_right() const { return { right(), top() }; }
+    constexpr Vec2 bottom_left() const { return { left(), bottom() }; }
+    constexpr Vec2 bottom_right() const { return { right(), bottom() }; }
+    constexpr Vec2 center() const { return { x + w / 2, y + h / 2 }; }
+
+    constexpr void move_left(double v) { x = v; }
+    constexpr void move_top(double v) { y = v; }
+    constexpr void move_right(double v) { x = v - w; }
+    constexpr void move_bottom(double v) { y = v - h; }
+    constexpr void move_top_left(Vec2 p) { x = p.x; y = p.y; }
+};
+
+/**
+ * @brief Checks if value is in range.
+ * @param val Value to check.
+ * @param start Smaller value in the range.
+ * @param end Larger value in the range.
+ * @return true if value is in the range, otherwise false.
+ */
+bool in_range(double val, double start, double end);
+
+/**
+ * @brief Checks if point is in circle.
+ * @param radius Radius of the circle.
+ * @param center Center of the circle.
+ * @param point Point to check.
+ * @return true if point is in circle, otherwise false.
+ */
+bool in_circle(double radius, Vec2 center, Vec2 point);
+
+/**
+ * @brief Calculates the discriminant of a 2x2 matrix.
+ * @param a First row.
+ * @param b Second row.
+ */
+double cross(Vec2 a, Vec2 b);
+
+/**
+ * @brief Calculates a point where two lines intersect.
+ * @param p1 Point trough which the first line passes.
+ * @param d1 Direction in which the first line goes.
+ * @param p2 Point trough which the second line passes.
+ * @param d2 Direction in which the second line goes.
+ * @return The intersection point.
+ */
+Vec2 line_intersection(Vec2 p1, Vec2 d1, Vec2 p2, Vec2 d2);
+
+/**
+ * @brief Calculates the distance of a segment from a given point in the given
+ * direction.
+ * @param p Point from which the segment distance is calculated.
+ * @param d Direction of the 'ray'.
+ * @param a First point of the segment (x or y must be smaller than b).
+ * @param b Second point of the segment (x or y must be larger than b).
+ * @return Distance of the segment from the point. INFINITY when the 'ray'
+ * doesn't touch the segment.
+ */
+double segment_distance(Vec2 p, Vec2 d, Vec2 a, Vec2 b);
+
+/**
+ * @brief Calculates the distance of a rectangle from a point in the given
+ * direction.
+ * @param p Point from which to calculate the distance.
+ * @param d Direction from the point ('ray').
+ * @param r Rectangle to calculate the distance from.
+ * @return Distance from the rectangle. INFINITY if the 'ray' doesn't touch the
+ * rectangle.
+ */
+double rect_distance(Vec2 p, Vec2 d, Rect r);
+
+/**
+ * @brief Calculates the distance of a circle from a point in the given
+ * direction.
+ * @param p Point from which to calculate the distance.
+ * @param d Unit direction from the point ('ray').
+ * @param c Center of the circle.
+ * @param r Radius of the circle.
+ * @return Distance from the circle. 0 if the point is inside of the circle
+ * and the center is in front of it. INFINITY if the 'ray' doesn't touch the
+ * circle or if the circle is behind the point.
+ */
+double circle_distance(Vec2 p, Vec2 d, Vec2 c, double r);
+
+/**
+ * @brief Calculates the distance of the closest of many rectangles from a
+ * point in the given direction. Uses the slab method and SIMD instructions
+ * if they are enabled at compile time. The result is the same as the
+ * minimum of `rect_distance` (up to the rounding errors).
+ * @param p Point from which to calculate the distance.
+ * @param d Unit direction from the point ('ray').
+ * @param left Left edges of the rectangles.
+ * @param top Top edges of the rectangles.
+ * @param right Right edges of the rectangles.
+ * @param bottom Bottom edges of the rectangles.
+ * @param n Number of the rectangles.
+ * @return Distance from the closest rectangle. INFINITY if the 'ray' doesn't
+ * touch any of the rectangles.
+ */
+double rect_distance_packed(
+    Vec2 p,
+    Vec2 d,
+    const double *left,
+    const double *top,
+    const double *right,
+    const double *bottom,
+    std::size_t n
+);
+
+} // namespace icp
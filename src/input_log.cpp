@@ -0,0 +1,416 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Log of the changes of the world made between the ticks. (source
+ * file)
+ */
+
+#include "input_log.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "little_endian.hpp"
+#include "state_file.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/** @brief Identifies the input log. */
+static const char MAGIC[8] = { 'I', 'C', 'P', 'I', 'N', 'P', 'U', 'T' };
+
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t INPUT_HEADER_SIZE = 24;
+constexpr size_t OBSTACLE_SIZE = 5 * 8;
+constexpr size_t GRAB_SIZE = 8;
+
+/**
+ * @brief Older version of the input log that can be read. It has the same
+ * layout, only without the kinds of inputs after `Restore`.
+ */
+constexpr uint32_t BASE_VERSION = 2;
+
+/**
+ * @brief Appends little-endian value to the buffer.
+ */
+template<typename T> static void put(vector<char> &buf, T val) {
+    buf.resize(buf.size() + sizeof(T));
+    write_le<T>(buf.data() + buf.size() - sizeof(T), val);
+}
+
+/**
+ * @brief Reads little-endian value and moves after it.
+ * @throws std::runtime_error when the data end before the value.
+ */
+template<typename T> static T get(const char *&p, const char *end) {
+    if (size_t(end - p) < sizeof(T)) {
+        throw runtime_error("Truncated input log");
+    }
+    auto res = read_le<T>(p);
+    p += sizeof(T);
+    return res;
+}
+
+static void put_robot(vector<char> &buf, const RobotState &robot) {
+    RobotArrays arr;
+    arr.push(robot);
+    arr.for_each_saved_array([&](auto &a) { put(buf, a[0]); });
+}
+
+static RobotState get_robot(const char *&p, const char *end) {
+    RobotArrays arr;
+    arr.for_each_saved_array([&](auto &a) {
+        using T = typename decay_t<decltype(a)>::value_type;
+        a.push_back(get<T>(p, end));
+    });
+    arr.update_directions();
+    if (static_cast<uint32_t>(arr.kind[0]) > 2) {
+        throw runtime_error("Invalid robot kind in input log");
+    }
+    if (arr.lidar_rays[0] > MAX_LIDAR_RAYS) {
+        throw runtime_error("Invalid number of lidar rays in input log");
+    }
+    return arr.get(0);
+}
+
+static void put_obstacle(vector<char> &buf, const ObstacleState &obstacle) {
+    put(buf, obstacle.hitbox.x);
+    put(buf, obstacle.hitbox.y);
+    put(buf, obstacle.hitbox.w);
+    put(buf, obstacle.hitbox.h);
+    put<uint8_t>(buf, obstacle.grabbed);
+    buf.resize(buf.size() + OBSTACLE_SIZE - 4 * 8 - 1, 0);
+}
+
+static ObstacleState get_obstacle(const char *&p, const char *end) {
+    if (size_t(end - p) < OBSTACLE_SIZE) {
+        throw runtime_error("Truncated input log");
+    }
+    ObstacleState res;
+    res.hitbox = Rect{
+        read_le<double>(p),
+        read_le<double>(p + 8),
+        read_le<double>(p + 16),
+        read_le<double>(p + 24),
+    };
+    res.grabbed = read_le<uint8_t>(p + 32);
+    p += OBSTACLE_SIZE;
+    return res;
+}
+
+//---------------------------------------------------------------------------//
+//                                   INPUT                                   //
+//---------------------------------------------------------------------------//
+
+Input Input::set_size(double width, double height) {
+    Input res;
+    res.kind = InputKind::SetSize;
+    res.width = width;
+    res.height = height;
+    return res;
+}
+
+Input Input::add_robot(const RobotState &robot) {
+    Input res;
+    res.kind = InputKind::AddRobot;
+    res.robot = robot;
+    return res;
+}
+
+Input Input::add_obstacle(const ObstacleState &obstacle) {
+    Input res;
+    res.kind = InputKind::AddObstacle;
+    res.obstacle = obstacle;
+    return res;
+}
+
+Input Input::remove_robot(size_t idx) {
+    Input res;
+    res.kind = InputKind::RemoveRobot;
+    res.idx = idx;
+    return res;
+}
+
+Input Input::remove_obstacle(size_t idx) {
+    Input res;
+    res.kind = InputKind::RemoveObstacle;
+    res.idx = idx;
+    return res;
+}
+
+Input Input::set_robot(size_t idx, const RobotState &robot) {
+    Input res;
+    res.kind = InputKind::SetRobot;
+    res.idx = idx;
+    res.robot = robot;
+    return res;
+}
+
+Input Input::set_obstacle(size_t idx, const ObstacleState &obstacle) {
+    Input res;
+    res.kind = InputKind::SetObstacle;
+    res.idx = idx;
+    res.obstacle = obstacle;
+    return res;
+}
+
+Input Input::restore(shared_ptr<const WorldState> state) {
+    Input res;
+    res.kind = InputKind::Restore;
+    res.state = std::move(state);
+    return res;
+}
+
+Input Input::move_robot(size_t idx, Vec2 position) {
+    Input res;
+    res.kind = InputKind::MoveRobot;
+    res.idx = idx;
+    res.position = position;
+    return res;
+}
+
+Input Input::set_robot_speed(size_t idx, double speed) {
+    Input res;
+    res.kind = InputKind::SetRobotSpeed;
+    res.idx = idx;
+    res.value = speed;
+    return res;
+}
+
+Input Input::set_robot_angle(size_t idx, double angle) {
+    Input res;
+    res.kind = InputKind::SetRobotAngle;
+    res.idx = idx;
+    res.value = angle;
+    return res;
+}
+
+Input Input::set_robot_grabbed(size_t idx, bool grabbed) {
+    Input res;
+    res.kind = InputKind::GrabRobot;
+    res.idx = idx;
+    res.grabbed = grabbed;
+    return res;
+}
+
+Input Input::set_robot_params(size_t idx, const RobotState &robot) {
+    Input res;
+    res.kind = InputKind::SetRobotParams;
+    res.idx = idx;
+    res.robot = robot;
+    return res;
+}
+
+void Input::apply(World &world) const {
+    switch (kind) {
+        case InputKind::SetSize:
+            world.set_size(width, height);
+            break;
+        case InputKind::AddRobot:
+            world.add_robot(robot);
+            break;
+        case InputKind::AddObstacle:
+            world.add_obstacle(obstacle);
+            break;
+        case InputKind::RemoveRobot:
+            world.remove_robot(idx);
+            break;
+        case InputKind::RemoveObstacle:
+            world.remove_obstacle(idx);
+            break;
+        case InputKind::SetRobot:
+            world.set_robot(idx, robot);
+            break;
+        case InputKind::SetObstacle:
+            world.set_obstacle(idx, obstacle);
+            break;
+        case InputKind::Restore:
+            world.restore(*state);
+            break;
+        case InputKind::MoveRobot:
+            world.move_robot(idx, position);
+            break;
+        case InputKind::SetRobotSpeed:
+            world.set_robot_speed(idx, value);
+            break;
+        case InputKind::SetRobotAngle:
+            world.set_robot_angle(idx, value);
+            break;
+        case InputKind::GrabRobot:
+            world.set_robot_grabbed(idx, grabbed);
+            break;
+        case InputKind::SetRobotParams:
+            world.set_robot_params(idx, robot);
+            break;
+    }
+}
+
+//---------------------------------------------------------------------------//
+//                                 INPUT LOG                                 //
+//---------------------------------------------------------------------------//
+
+bool is_input_log(const char *data, size_t size) {
+    return size >= sizeof(MAGIC) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+vector<Input> load_input_log(const char *data, size_t size) {
+    if (!is_input_log(data, size)) {
+        throw runtime_error("Not an input log");
+    }
+    if (size < HEADER_SIZE) {
+        throw runtime_error("Truncated input log");
+    }
+
+    auto version = read_le<uint32_t>(data + 8);
+    // version 3 had different layout of the robots and cannot be read
+    if (version != BASE_VERSION && version != INPUT_LOG_VERSION) {
+        throw runtime_error(
+            "Unsupported input log version " + to_string(version)
+        );
+    }
+
+    vector<Input> res;
+    auto p = data + HEADER_SIZE;
+    auto end = data + size;
+    while (p != end) {
+        auto tick = get<uint64_t>(p, end);
+        auto kind = get<uint32_t>(p, end);
+        get<uint32_t>(p, end);
+        auto idx = get<uint64_t>(p, end);
+        auto last = version == BASE_VERSION
+            ? InputKind::Restore : InputKind::SetRobotParams;
+        if (kind > static_cast<uint32_t>(last)) {
+            throw runtime_error("Invalid kind of input in input log");
+        }
+
+        Input input;
+        input.kind = static_cast<InputKind>(kind);
+        input.tick = tick;
+        input.idx = idx;
+        switch (input.kind) {
+            case InputKind::SetSize:
+                input.width = get<double>(p, end);
+                input.height = get<double>(p, end);
+                break;
+            case InputKind::AddRobot:
+            case InputKind::SetRobot:
+            case InputKind::SetRobotParams:
+                input.robot = get_robot(p, end);
+                break;
+            case InputKind::AddObstacle:
+            case InputKind::SetObstacle:
+                input.obstacle = get_obstacle(p, end);
+                break;
+            case InputKind::MoveRobot:
+                input.position.x = get<double>(p, end);
+                input.position.y = get<double>(p, end);
+                break;
+            case InputKind::SetRobotSpeed:
+            case InputKind::SetRobotAngle:
+                input.value = get<double>(p, end);
+                break;
+            case InputKind::GrabRobot:
+                if (size_t(end - p) < GRAB_SIZE) {
+                    throw runtime_error("Truncated input log");
+                }
+                input.grabbed = read_le<uint8_t>(p);
+                p += GRAB_SIZE;
+                break;
+            case InputKind::RemoveRobot:
+            case InputKind::RemoveObstacle:
+                break;
+            case InputKind::Restore: {
+                auto len = get<uint64_t>(p, end);
+                if (len > size_t(end - p)) {
+                    throw runtime_error("Truncated input log");
+                }
+                input.state = make_shared<const WorldState>(
+                    load_state_file(p, len)
+                );
+                p += len;
+                break;
+            }
+        }
+        res.push_back(std::move(input));
+    }
+
+    return res;
+}
+
+//---------------------------------------------------------------------------//
+//                             INPUT LOG WRITER                              //
+//---------------------------------------------------------------------------//
+
+InputLogWriter::InputLogWriter(const string &filename) :
+    mtx(),
+    out(filename, ios::binary)
+{
+    if (!out) {
+        throw runtime_error("Failed to create the file '" + filename + "'");
+    }
+
+    char header[HEADER_SIZE] = { 0 };
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    write_le<uint32_t>(header + 8, INPUT_LOG_VERSION);
+    out.write(header, sizeof(header));
+    out.flush();
+}
+
+void InputLogWriter::write(const Input &input) {
+    vector<char> buf;
+    buf.reserve(INPUT_HEADER_SIZE + OBSTACLE_SIZE);
+    put<uint64_t>(buf, input.tick);
+    put<uint32_t>(buf, static_cast<uint32_t>(input.kind));
+    put<uint32_t>(buf, 0);
+    put<uint64_t>(buf, input.idx);
+
+    switch (input.kind) {
+        case InputKind::SetSize:
+            put(buf, input.width);
+            put(buf, input.height);
+            break;
+        case InputKind::AddRobot:
+        case InputKind::SetRobot:
+        case InputKind::SetRobotParams:
+            put_robot(buf, input.robot);
+            break;
+        case InputKind::AddObstacle:
+        case InputKind::SetObstacle:
+            put_obstacle(buf, input.obstacle);
+            break;
+        case InputKind::MoveRobot:
+            put(buf, input.position.x);
+            put(buf, input.position.y);
+            break;
+        case InputKind::SetRobotSpeed:
+        case InputKind::SetRobotAngle:
+            put(buf, input.value);
+            break;
+        case InputKind::GrabRobot:
+            put<uint8_t>(buf, input.grabbed);
+            buf.resize(buf.size() + GRAB_SIZE - 1, 0);
+            break;
+        case InputKind::RemoveRobot:
+        case InputKind::RemoveObstacle:
+            break;
+        case InputKind::Restore:
+            put<uint64_t>(buf, state_file_size(*input.state));
+            break;
+    }
+
+    lock_guard<mutex> lock(mtx);
+    out.write(buf.data(), buf.size());
+    if (input.kind == InputKind::Restore) {
+        save_state_file(*input.state, out);
+    }
+    out.flush();
+}
+
+bool InputLogWriter::good() {
+    lock_guard<mutex> lock(mtx);
+    return out.good();
+}
+
+} // namespace icp
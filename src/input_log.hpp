@@ -0,0 +1,178 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Log of the changes of the world made between the ticks. (header
+ * file)
+ *
+ * All the values are little-endian. The file starts with header:
+ *  - magic `ICPINPUT` (8 bytes)
+ *  - version (u32), currently `INPUT_LOG_VERSION`
+ *  - reserved (u32), zero
+ *
+ * Then there are the inputs in the order in which they were applied, each of
+ * them is:
+ *  - tick of the world before which the input was applied (u64)
+ *  - kind (u32), value of `InputKind`
+ *  - reserved (u32), zero
+ *  - index of the robot or obstacle (u64), zero if the kind has none
+ *
+ * followed by the data of the input by its kind:
+ *  - `SetSize`: width and height (f64 each)
+ *  - `AddRobot` and `SetRobot`: the robot as single item of each of the
+ *    arrays of the state file (see `state_file.hpp`)
+ *  - `AddObstacle` and `SetObstacle`: the obstacle as in the state file
+ *  - `RemoveRobot` and `RemoveObstacle`: nothing
+ *  - `Restore`: size of the state (u64) and the state in the format of the
+ *    state file
+ *  - `MoveRobot`: x and y of the top-left corner of the hitbox (f64 each)
+ *  - `SetRobotSpeed` and `SetRobotAngle`: the speed or the angle (f64)
+ *  - `GrabRobot`: grabbed flag (u8) and 7 reserved zero bytes
+ *  - `SetRobotParams`: the robot as in `SetRobot`
+ *
+ * Version 2 is also read, it has only the kinds up to `Restore`. Version 3
+ * stored also the directions of the robots, it is not supported.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "world.hpp"
+
+namespace icp {
+
+/**
+ * @brief Version of the input log written by `InputLogWriter`.
+ */
+constexpr std::uint32_t INPUT_LOG_VERSION = 4;
+
+/**
+ * @brief Extension of the input log files.
+ */
+constexpr const char *INPUT_LOG_EXT = ".input";
+
+/**
+ * @brief Kind of change of the world.
+ */
+enum class InputKind : std::uint32_t {
+    SetSize,
+    AddRobot,
+    AddObstacle,
+    RemoveRobot,
+    RemoveObstacle,
+    SetRobot,
+    SetObstacle,
+    /** @brief The whole world is replaced. */
+    Restore,
+    MoveRobot,
+    SetRobotSpeed,
+    SetRobotAngle,
+    GrabRobot,
+    SetRobotParams,
+};
+
+/**
+ * @brief Single change of the world made between the ticks (e.g. by the
+ * user). The fields that the kind doesn't use are ignored.
+ */
+struct Input {
+    /** @brief Creates input that calls `World::set_size`. */
+    static Input set_size(double width, double height);
+    /** @brief Creates input that calls `World::add_robot`. */
+    static Input add_robot(const RobotState &robot);
+    /** @brief Creates input that calls `World::add_obstacle`. */
+    static Input add_obstacle(const ObstacleState &obstacle);
+    /** @brief Creates input that calls `World::remove_robot`. */
+    static Input remove_robot(std::size_t idx);
+    /** @brief Creates input that calls `World::remove_obstacle`. */
+    static Input remove_obstacle(std::size_t idx);
+    /** @brief Creates input that calls `World::set_robot`. */
+    static Input set_robot(std::size_t idx, const RobotState &robot);
+    /** @brief Creates input that calls `World::set_obstacle`. */
+    static Input set_obstacle(std::size_t idx, const ObstacleState &obstacle);
+    /** @brief Creates input that calls `World::restore`. */
+    static Input restore(std::shared_ptr<const WorldState> state);
+    /** @brief Creates input that calls `World::move_robot`. */
+    static Input move_robot(std::size_t idx, Vec2 position);
+    /** @brief Creates input that calls `World::set_robot_speed`. */
+    static Input set_robot_speed(std::size_t idx, double speed);
+    /** @brief Creates input that calls `World::set_robot_angle`. */
+    static Input set_robot_angle(std::size_t idx, double angle);
+    /** @brief Creates input that calls `World::set_robot_grabbed`. */
+    static Input set_robot_grabbed(std::size_t idx, bool grabbed);
+    /** @brief Creates input that calls `World::set_robot_params`. */
+    static Input set_robot_params(std::size_t idx, const RobotState &robot);
+
+    /**
+     * @brief Applies the change to the world.
+     */
+    void apply(World &world) const;
+
+    InputKind kind = InputKind::SetSize;
+    /** @brief Tick of the world before which the input was applied. */
+    std::uint64_t tick = 0;
+    /** @brief Index of the robot or obstacle. */
+    std::size_t idx = 0;
+    double width = 0;
+    double height = 0;
+    /** @brief New position of the robot. */
+    Vec2 position{ 0, 0 };
+    /** @brief New speed or angle of the robot. */
+    double value = 0;
+    bool grabbed = false;
+    RobotState robot{};
+    ObstacleState obstacle;
+    std::shared_ptr<const WorldState> state;
+};
+
+/**
+ * @brief Checks whether the data start with the header of the input log.
+ */
+bool is_input_log(const char *data, std::size_t size);
+
+/**
+ * @brief Loads all the inputs from the input log.
+ * @param data Contents of the file.
+ * @param size Size of the contents in bytes.
+ * @throws std::runtime_error when the data are not valid.
+ */
+std::vector<Input> load_input_log(const char *data, std::size_t size);
+
+/**
+ * @brief Writes the inputs to the input log as they are applied. Each input
+ * is flushed immediately, so the log is complete even if the program
+ * crashes. It may be shared by multiple simulations.
+ */
+class InputLogWriter {
+public:
+    /**
+     * @brief Creates the file and writes its header.
+     * @param filename Path to the file.
+     * @throws std::runtime_error when the file cannot be created.
+     */
+    InputLogWriter(const std::string &filename);
+
+    /**
+     * @brief Appends the input to the log. Errors are only remembered (see
+     * `good`) so that the simulation isn't interrupted.
+     */
+    void write(const Input &input);
+
+    /**
+     * @brief Checks whether all the inputs were written successfully.
+     */
+    bool good();
+
+private:
+    std::mutex mtx;
+    // guarded by `mtx`
+    std::ofstream out;
+};
+
+} // namespace icp
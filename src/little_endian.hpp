@@ -0,0 +1,100 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Reading and writing of little-endian values in binary files.
+ * (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace icp {
+
+/**
+ * @brief Swaps the bytes of the value to/from little-endian on big-endian
+ * machines.
+ * @tparam U Unsigned integer with size 1, 4 or 8 bytes.
+ */
+template<typename U> inline U le_bits(U bits) {
+    static_assert(sizeof(U) == 1 || sizeof(U) == 4 || sizeof(U) == 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr (sizeof(U) == 4) {
+        bits = __builtin_bswap32(bits);
+    } else if constexpr (sizeof(U) == 8) {
+        bits = __builtin_bswap64(bits);
+    }
+#endif
+    return bits;
+}
+
+/**
+ * @brief Unsigned integer with the same size as `T`.
+ */
+template<typename T> using LeBits = std::conditional_t<
+    sizeof(T) == 1,
+    std::uint8_t,
+    std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>
+>;
+
+/**
+ * @brief Reads little-endian value.
+ * @tparam T Type with size 1, 4 or 8 bytes.
+ */
+template<typename T> inline T read_le(const char *data) {
+    LeBits<T> bits;
+    std::memcpy(&bits, data, sizeof(bits));
+    bits = le_bits(bits);
+
+    T res;
+    std::memcpy(&res, &bits, sizeof(res));
+    return res;
+}
+
+/**
+ * @brief Writes value as little-endian.
+ * @tparam T Type with size 1, 4 or 8 bytes.
+ */
+template<typename T> inline void write_le(char *data, T val) {
+    LeBits<T> bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    bits = le_bits(bits);
+    std::memcpy(data, &bits, sizeof(bits));
+}
+
+/**
+ * @brief Reads array of little-endian values. On little-endian machines it
+ * is just copy of the memory.
+ * @tparam T Type with size 1, 4 or 8 bytes.
+ */
+template<typename T>
+inline void read_le_array(const char *data, T *dst, std::size_t n) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (std::size_t i = 0; i < n; ++i) {
+        dst[i] = read_le<T>(data + i * sizeof(T));
+    }
+#else
+    std::memcpy(dst, data, n * sizeof(T));
+#endif
+}
+
+/**
+ * @brief Writes array of values as little-endian. On little-endian machines
+ * it is just copy of the memory.
+ * @tparam T Type with size 1, 4 or 8 bytes.
+ */
+template<typename T>
+inline void write_le_array(char *data, const T *src, std::size_t n) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (std::size_t i = 0; i < n; ++i) {
+        write_le<T>(data + i * sizeof(T), src[i]);
+    }
+#else
+    std::memcpy(data, src, n * sizeof(T));
+#endif
+}
+
+} // namespace icp
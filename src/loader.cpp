@@ -6,63 +6,196 @@
 
 #include "loader.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+#include "binary_room.hpp"
+#include "mapped_file.hpp"
+#include "state_file.hpp"
+
 namespace icp {
 
 using namespace std;
 
+/**
+ * @brief Values of robot attributes in the units of the room file.
+ */
+struct RobotParams {
+    double speed = 0;
+    double angle = -90;
+    double elide_dist = 20;
+    double elide_rot = M_PI / M_E;
+    double rot_speed = M_PI / 4;
+    double lidar_rays = 0;
+    double lidar_fov = 180;
+};
+
+/**
+ * @brief Gets the bit of robot kind in `RobotAttribute::kinds`.
+ */
+static constexpr unsigned kind_bit(RobotKind kind) {
+    return 1 << static_cast<unsigned>(kind);
+}
+
+/**
+ * @brief Attribute of robot in the room file.
+ */
+struct RobotAttribute {
+    string_view name;
+    double RobotParams::*value;
+    /** @brief Kinds of robots that can have the attribute. */
+    unsigned kinds;
+};
+
+constexpr unsigned ALL_KINDS = kind_bit(RobotKind::Dummy)
+    | kind_bit(RobotKind::Auto)
+    | kind_bit(RobotKind::Control);
+
+static const RobotAttribute ROBOT_ATTRIBUTES[] = {
+    { "speed", &RobotParams::speed, ALL_KINDS },
+    { "angle", &RobotParams::angle, ALL_KINDS },
+    {
+        "rotation_speed",
+        &RobotParams::rot_speed,
+        kind_bit(RobotKind::Auto) | kind_bit(RobotKind::Control),
+    },
+    {
+        "elide_distance",
+        &RobotParams::elide_dist,
+        kind_bit(RobotKind::Auto),
+    },
+    {
+        "elide_rotation",
+        &RobotParams::elide_rot,
+        kind_bit(RobotKind::Auto),
+    },
+    { "lidar_rays", &RobotParams::lidar_rays, ALL_KINDS },
+    { "lidar_angle", &RobotParams::lidar_fov, ALL_KINDS },
+};
+
+/**
+ * @brief Identifiers of the robots in the room file.
+ */
+static const pair<string_view, RobotKind> ROBOT_KINDS[] = {
+    { "robot", RobotKind::Dummy },
+    { "auto_robot", RobotKind::Auto },
+    { "control_robot", RobotKind::Control },
+};
+
+// faster than the locale aware functions from <cctype>, the file is ASCII
+
+static bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool is_ident(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
 Loader::Loader(string filename)
-    : cur('\0'),
-    filename(filename)
+    : filename(filename),
+    cur(nullptr),
+    end(nullptr)
 {}
 
-Room *Loader::load(QWidget *window) {
-    auto room = new Room();
+World Loader::load(const Progress &progress) {
+    MappedFile map(filename);
+    if (is_binary_room(map.data(), map.size())) {
+        return load_binary_room(map.data(), map.size(), progress);
+    }
+    if (is_state_file(map.data(), map.size())) {
+        World world;
+        world.restore(load_state_file(map.data(), map.size()));
+        if (progress) {
+            progress(1);
+        }
+        return world;
+    }
+    return load_text(map.data(), map.size(), progress);
+}
+
+World Loader::load_text(
+    const char *data,
+    size_t size,
+    const Progress &progress
+) {
+    return Loader(data, size).parse(progress);
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
 
-    file = ifstream(filename);
-    if (!file.is_open())
-        throw runtime_error("File cannot be accessed");
+Loader::Loader(const char *data, size_t size)
+    : filename(),
+    cur(data),
+    end(data + size)
+{}
 
+World Loader::parse(const Progress &progress) {
+    World world;
+
+    auto start = cur;
+    size_t count = 0;
     bool sroom = false;
     auto ident = read_ident();
     while (ident != "") {
+        if (progress && ++count % PROGRESS_STEP == 0) {
+            progress(double(cur - start) / (end - start));
+        }
+
+        auto robot = find_if(
+            begin(ROBOT_KINDS),
+            std::end(ROBOT_KINDS),
+            [&](auto &k) { return k.first == ident; }
+        );
+
         if (ident == "room") {
             if (sroom)
                 throw runtime_error("Room can be set only once");
 
             auto size = read_size();
-            window->resize(size.width(), size.height() + 80);
+            world.set_size(size.x, size.y);
             sroom = true;
         } else if (ident == "obstacle") {
-            room->add_obstacle(unique_ptr<Obstacle>(load_obstacle()));
-        } else if (ident == "robot") {
-            room->add_robot(unique_ptr<Robot>(load_robot()));
-        } else if (ident == "auto_robot") {
-            room->add_robot(unique_ptr<Robot>(load_auto_robot()));
-        } else if (ident == "control_robot") {
-            room->add_robot(unique_ptr<Robot>(load_control_robot()));
+            world.add_obstacle(load_obstacle());
+        } else if (robot != std::end(ROBOT_KINDS)) {
+            world.add_robot(load_robot(robot->second));
         } else {
-            throw runtime_error("Unexpected identifier: '" + ident + "'");
+            throw runtime_error(
+                "Unexpected identifier: '" + string(ident) + "'"
+            );
         }
         ident = read_ident();
     }
-    file.close();
-    return room;
+
+    if (progress) {
+        progress(1);
+    }
+    return world;
 }
 
-Obstacle *Loader::load_obstacle() {
-    QPointF pos;
-    QSizeF size;
+ObstacleState Loader::load_obstacle() {
+    Vec2 pos{ 0, 0 };
+    Vec2 size{ 0, 0 };
     bool spos = false, ssize = false;
 
     while (!spos || !ssize) {
-        if (!(file >> cur))
+        char c;
+        if (!next(c))
             throw runtime_error("Obstacle requires size and position");
 
-        if (isdigit(cur) && !ssize) {
-            file.seekg((int)file.tellg() - 1);
+        if (c >= '0' && c <= '9' && !ssize) {
+            --cur;
             size = read_size();
             ssize = true;
-        } else if (cur == '[' && !spos) {
+        } else if (c == '[' && !spos) {
             pos = read_pos();
             spos = true;
         } else {
@@ -70,201 +203,152 @@ Obstacle *Loader::load_obstacle() {
         }
     }
 
-    auto rect = QRectF(pos, size);
-    auto obst = new Obstacle(rect);
-    obst->set_hitbox(rect);
-    return obst;
+    return ObstacleState{ Rect{ pos.x, pos.y, size.x, size.y } };
 }
 
-Robot *Loader::load_robot() {
-    qreal speed = 0, angle = -90;
-    QPointF pos;
-    bool spos = false, sopt = false;
+RobotState Loader::load_robot(RobotKind kind) {
+    RobotParams params;
+    Vec2 pos{ 0, 0 };
+    bool spos = false;
 
-    while (!spos || !sopt) {
-        if (!(file >> cur)) {
+    while (true) {
+        char c;
+        if (!next(c)) {
             if (spos)
                 break;
             throw runtime_error("Robot requires position");
         }
 
-        if (cur == '[') {
+        if (c == '[') {
             pos = read_pos();
             spos = true;
-        } else if (cur == '{') {
+        } else if (c == '{') {
             while (true) {
                 auto ident = read_ident();
-                if (ident == "speed") {
-                    file >> speed;
-                } else if (ident == "angle") {
-                    file >> angle;
-                } else {
+                auto attr = find_if(
+                    begin(ROBOT_ATTRIBUTES),
+                    std::end(ROBOT_ATTRIBUTES),
+                    [&](auto &a) {
+                        return a.name == ident && (a.kinds & kind_bit(kind));
+                    }
+                );
+                if (attr == std::end(ROBOT_ATTRIBUTES)) {
                     throw runtime_error(
-                        "Unexpected robot attribute: '" + ident + "'"
+                        "Unexpected robot attribute: '" + string(ident) + "'"
                     );
                 }
+                params.*attr->value = read_number("Unexpected character");
 
-                file >> cur;
-                if (cur == '}')
+                if (!next(c))
+                    throw runtime_error("Unexpected character");
+                if (c == '}')
                     break;
-                if (cur == ',')
+                if (c == ',')
                     continue;
 
                 throw runtime_error("Unexpected character");
             }
         } else {
-            file.seekg((int)file.tellg() - 1);
-            sopt = true;
-        }
-    }
-
-    angle = -angle * M_PI / 180.0;
-    auto rob = new Robot(pos, angle, speed);
-    rob->set_hitbox(QRectF(pos, QSizeF(0, 0)));
-    return rob;
-}
-
-AutoRobot *Loader::load_auto_robot() {
-    qreal speed = 0, angle = -90, el = 20, el_r = M_PI / M_E, r = M_PI / 4;
-    QPointF pos;
-    bool spos = false, sopt = false;
-
-    while (!spos || !sopt) {
-        if (!(file >> cur)) {
+            // start of the next identifier
+            --cur;
             if (spos)
                 break;
             throw runtime_error("Robot requires position");
         }
-
-        if (cur == '[') {
-            pos = read_pos();
-            spos = true;
-        } else if (cur == '{') {
-            while (true) {
-                auto ident = read_ident();
-                if (ident == "speed") {
-                    file >> speed;
-                } else if (ident == "angle") {
-                    file >> angle;
-                } else if (ident == "elide_distance") {
-                    file >> el;
-                } else if (ident == "elide_rotation") {
-                    file >> el_r;
-                } else if (ident == "rotation_speed") {
-                    file >> r;
-                } else {
-                    throw runtime_error(
-                        "Unexpected robot attribute: '" + ident + "'"
-                    );
-                }
-
-                file >> cur;
-                if (cur == '}')
-                    break;
-                if (cur == ',')
-                    continue;
-
-                throw runtime_error("Unexpected character");
-            }
-        } else {
-            file.seekg((int)file.tellg() - 1);
-            sopt = true;
-        }
     }
 
-    angle = -angle * M_PI / 180.0;
-    auto rob = new AutoRobot(
-        pos, angle, speed, el, el_r * M_PI / 180, r * M_PI / 180
-    );
-    rob->set_hitbox(QRectF(pos, QSizeF(0, 0)));
-    return rob;
-}
-
-ControlRobot *Loader::load_control_robot() {
-    qreal speed = 0, angle = -90, r = M_PI / 4;
-    QPointF pos;
-    bool spos = false, sopt = false;
-
-    while (!spos || !sopt) {
-        if (!(file >> cur)) {
-            if (spos)
-                break;
-            throw runtime_error("Robot requires position");
-        }
-
-        if (cur == '[') {
-            pos = read_pos();
-            spos = true;
-        } else if (cur == '{') {
-            while (true) {
-                auto ident = read_ident();
-                if (ident == "speed") {
-                    file >> speed;
-                } else if (ident == "angle") {
-                    file >> angle;
-                } else if (ident == "rotation_speed") {
-                    file >> r;
-                } else {
-                    throw runtime_error(
-                        "Unexpected robot attribute: '" + ident + "'"
-                    );
-                }
-
-                file >> cur;
-                if (cur == '}')
-                    break;
-                if (cur == ',')
-                    continue;
+    auto rays = params.lidar_rays;
+    if (!(rays >= 0 && rays <= MAX_LIDAR_RAYS) || rays != floor(rays)) {
+        throw runtime_error("Invalid number of lidar rays");
+    }
 
-                throw runtime_error("Unexpected character");
-            }
-        } else {
-            file.seekg((int)file.tellg() - 1);
-            sopt = true;
-        }
+    RobotState res;
+    auto angle = -params.angle * M_PI / 180.0;
+    switch (kind) {
+        case RobotKind::Auto:
+            res = RobotState::automatic(
+                pos,
+                angle,
+                params.speed,
+                params.elide_dist,
+                params.elide_rot * M_PI / 180,
+                params.rot_speed * M_PI / 180
+            );
+            break;
+        case RobotKind::Control:
+            res = RobotState::controlled(
+                pos, angle, params.speed, params.rot_speed * M_PI / 180
+            );
+            break;
+        default:
+            res = RobotState::dummy(pos, angle, params.speed);
+            break;
     }
+    res.lidar_rays = rays;
+    res.lidar_fov = params.lidar_fov * M_PI / 180;
+    return res;
+}
 
-    angle = -angle * M_PI / 180.0;
-    auto rob = new ControlRobot(pos, angle, speed, r * M_PI / 180);
-    rob->set_hitbox(QRectF(pos, QSizeF(0, 0)));
-    return rob;
+bool Loader::next(char &c) {
+    while (cur != end && is_space(*cur))
+        ++cur;
+    if (cur == end)
+        return false;
+    c = *cur++;
+    return true;
 }
 
-string Loader::read_ident() {
-    string res = "";
-    file >> ws;
-    while (file.get(cur)) {
-        if (!isalpha(cur) && cur != '_')
-            break;
-        res += cur;
-    }
+string_view Loader::read_ident() {
+    while (cur != end && is_space(*cur))
+        ++cur;
+
+    auto start = cur;
+    while (cur != end && is_ident(*cur))
+        ++cur;
+    string_view res(start, cur - start);
 
-    if (cur == ':' || (cur == ' ' && file >> ws >> cur && cur == ':') || res == "")
+    char c;
+    if ((next(c) && c == ':') || res == "")
         return res;
     throw runtime_error("Identifier must be followed by ':'");
 }
 
-QSizeF Loader::read_size() {
-    qreal w, h;
-    file >> w;
-    if (!(file >> cur && cur == 'x'))
+double Loader::read_number(const char *error) {
+    while (cur != end && is_space(*cur))
+        ++cur;
+    // `from_chars` doesn't accept explicit plus sign
+    if (cur != end && *cur == '+')
+        ++cur;
+
+    double res;
+    auto [ptr, ec] = from_chars(cur, end, res);
+    if (ec != errc())
+        throw runtime_error(error);
+    cur = ptr;
+    return res;
+}
+
+Vec2 Loader::read_size() {
+    auto w = read_number("Invalid character in size");
+    char c;
+    if (!(next(c) && c == 'x'))
         throw runtime_error("Invalid character in size");
 
-    file >> h;
-    return QSizeF(w, h);
+    auto h = read_number("Invalid character in size");
+    return Vec2{ w, h };
 }
 
-QPointF Loader::read_pos() {
-    qreal x, y;
-    file >> x;
-    if (!(file >> cur && cur == ','))
+Vec2 Loader::read_pos() {
+    auto x = read_number("Invalid character in position");
+    char c;
+    if (!(next(c) && c == ','))
         throw runtime_error("Invalid character in position");
 
-    file >> y;
-    if (!(file >> cur && cur == ']'))
+    auto y = read_number("Invalid character in position");
+    if (!(next(c) && c == ']'))
         throw runtime_error("Unclosed position");
 
-    return QPointF(x, y);
+    return Vec2{ x, y };
 }
 
 } // namespace icp
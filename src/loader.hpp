@@ -7,15 +7,9 @@
 #pragma once
 
 #include <string>
-#include <fstream>
+#include <string_view>
 
-#include <QWidget>
-
-#include "auto_robot.hpp"
-#include "control_robot.hpp"
-#include "robot.hpp"
-#include "room.hpp"
-#include "obstacle.hpp"
+#include "world.hpp"
 
 namespace icp {
 
@@ -27,23 +21,43 @@ public:
     Loader(std::string filename);
 
     /**
-     * @brief Loads the Room from file
+     * @brief Loads the room from file in the text or binary format or from
+     * state file (it is detected from the contents). The size of the world
+     * is left at 0x0 when the file doesn't specify it.
+     * @param progress Called from time to time during the load.
+     */
+    World load(const Progress &progress = Progress());
+
+    /**
+     * @brief Loads the room from contents of file in the text format.
+     * @param data Contents of the file.
+     * @param size Size of the contents in bytes.
+     * @param progress Called from time to time during the load.
      */
-    Room *load(QWidget *window);
+    static World load_text(
+        const char *data,
+        std::size_t size,
+        const Progress &progress = Progress()
+    );
 
 private:
-    Obstacle *load_obstacle();
-    Robot *load_robot();
-    AutoRobot *load_auto_robot();
-    ControlRobot *load_control_robot();
+    Loader(const char *data, std::size_t size);
+
+    World parse(const Progress &progress);
+
+    ObstacleState load_obstacle();
+    RobotState load_robot(RobotKind kind);
 
-    std::string read_ident();
-    QSizeF read_size();
-    QPointF read_pos();
+    bool next(char &c);
+    std::string_view read_ident();
+    double read_number(const char *error);
+    Vec2 read_size();
+    Vec2 read_pos();
 
     std::string filename;
-    std::ifstream file;
-    char cur;
+    // the text that is not parsed yet
+    const char *cur;
+    const char *end;
 };
 
 
@@ -11,16 +11,84 @@
  */
 
 
+#include <exception>
 #include <iostream>
 
 #include <QApplication>
+#include <QCommandLineParser>
 
 #include "window.hpp"
 
 int main(int argc, char **argv) {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption rewind(
+        "rewind-budget",
+        "Memory for the history to which the simulation can be rewound.",
+        "MB",
+        QString::number(icp::REWIND_BUDGET / (1024 * 1024))
+    );
+    parser.addOption(rewind);
+    QCommandLineOption deterministic(
+        "deterministic",
+        "Simulate so that the results are bit-identical when repeated."
+    );
+    parser.addOption(deterministic);
+    QCommandLineOption input_log(
+        "input-log",
+        "Write all the changes of the room to the file, so that the"
+        " simulation can be repeated by icp-robots-sim (implies"
+        " --deterministic).",
+        "file"
+    );
+    parser.addOption(input_log);
+    QCommandLineOption obstacle_grid(
+        "obstacle-grid",
+        "Find the obstacles in front of the robots by walking uniform grid of"
+        " the obstacles (faster with many obstacles)."
+    );
+    parser.addOption(obstacle_grid);
+    QCommandLineOption distance_field(
+        "distance-field",
+        "Find the obstacles in front of the robots using precomputed"
+        " distances to the obstacles (faster with many obstacles)."
+    );
+    parser.addOption(distance_field);
+    QCommandLineOption ignore_robots(
+        "ignore-robots",
+        "The robots don't see the other robots, only the obstacles (the"
+        " robots then just push each other)."
+    );
+    parser.addOption(ignore_robots);
+    parser.process(app);
+
     icp::Window window;
+    window.set_rewind_budget(
+        parser.value(rewind).toULongLong() * 1024 * 1024
+    );
+    window.set_deterministic(
+        parser.isSet(deterministic) || parser.isSet(input_log)
+    );
+    if (parser.isSet(obstacle_grid)) {
+        window.set_sensing(icp::Sensing::Grid);
+    }
+    if (parser.isSet(distance_field)) {
+        window.set_sensing(icp::Sensing::DistanceField);
+    }
+    if (parser.isSet(ignore_robots)) {
+        window.set_robot_sensing(false);
+    }
+    if (parser.isSet(input_log)) {
+        try {
+            window.set_input_log(parser.value(input_log).toStdString());
+        } catch (const std::exception &e) {
+            std::cerr << "Error creating input log: " << e.what()
+                << std::endl;
+            return 1;
+        }
+    }
     window.show();
 
     app.exec();
@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Read only file mapped to memory. (source file)
+ */
+
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace icp {
+
+using namespace std;
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+MappedFile::MappedFile(const string &filename) : mdata(nullptr), msize(0) {
+    auto fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("File cannot be accessed");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        throw runtime_error("File cannot be accessed");
+    }
+
+    msize = st.st_size;
+    // empty file cannot be mapped
+    if (msize != 0) {
+        auto map = mmap(nullptr, msize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("File cannot be accessed");
+        }
+        // the file is always read from start to end
+        madvise(map, msize, MADV_SEQUENTIAL);
+        mdata = static_cast<const char *>(map);
+    }
+
+    // the mapping stays valid without the descriptor
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (mdata) {
+        munmap(const_cast<char *>(mdata), msize);
+    }
+}
+
+} // namespace icp
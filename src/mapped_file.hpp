@@ -0,0 +1,47 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Read only file mapped to memory. (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace icp {
+
+/**
+ * @brief Maps the whole file to memory for reading. The mapping is removed
+ * when the object is destroyed.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps the file to memory.
+     * @param filename Path to the file.
+     * @throws std::runtime_error when the file cannot be opened or mapped.
+     */
+    MappedFile(const std::string &filename);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile();
+
+    /**
+     * @brief Gets the contents of the file (`nullptr` if it is empty).
+     */
+    const char *data() const { return mdata; }
+
+    /**
+     * @brief Gets the size of the file in bytes.
+     */
+    std::size_t size() const { return msize; }
+
+private:
+    const char *mdata;
+    std::size_t msize;
+};
+
+} // namespace icp
@@ -12,6 +12,8 @@
 #include <QPen>
 #include <QGraphicsSceneMouseEvent>
 
+#include "convert.hpp"
+
 namespace icp {
 
 using namespace std;
@@ -73,7 +75,10 @@ Obstacle::State operator~(const Obstacle::State &s) {
 //---------------------------------------------------------------------------//
 
 Obstacle::Obstacle(QRectF hitbox, QGraphicsItem *parent)
-    : QGraphicsRectItem(hitbox, parent)
+    : QGraphicsRectItem(hitbox, parent),
+    mstate(State::None),
+    sim(nullptr),
+    idx(0)
 {
     setBrush(QBrush(QColor(0xff, 0x55, 0x55)));
     setPen(QPen(
@@ -94,10 +99,20 @@ QRectF Obstacle::hitbox() const {
 void Obstacle::set_hitbox(QRectF hitbox) {
     constexpr qreal ADJ = BORDER_THICKNESS / 2;
     setRect(hitbox.adjusted(ADJ, ADJ, -ADJ, -ADJ));
+    commit();
 }
 
 bool Obstacle::is_grabbed() const {
-    return state == State::Dragging;
+    return mstate == State::Dragging;
+}
+
+void Obstacle::bind(Simulation *sim, size_t idx) {
+    this->sim = sim;
+    this->idx = idx;
+}
+
+ObstacleState Obstacle::state() const {
+    return ObstacleState{ to_rect(hitbox()), is_grabbed() };
 }
 
 //---------------------------------------------------------------------------//
@@ -123,9 +138,10 @@ void Obstacle::mousePressEvent(QGraphicsSceneMouseEvent *event) {
     set_selected();
 
     if (event->button() & Qt::LeftButton) {
-        if (state == State::None) {
+        if (mstate == State::None) {
             setCursor(Qt::ClosedHandCursor);
-            state = State::Dragging;
+            mstate = State::Dragging;
+            commit();
         }
         grabMouse();
     }
@@ -134,7 +150,8 @@ void Obstacle::mousePressEvent(QGraphicsSceneMouseEvent *event) {
 void Obstacle::mouseReleaseEvent(QGraphicsSceneMouseEvent *event) {
     setZValue(0);
     if (event->button() & Qt::LeftButton) {
-        state = State::None;
+        mstate = State::None;
+        commit();
         ungrabMouse();
     }
 }
@@ -143,33 +160,34 @@ void Obstacle::mouseMoveEvent(QGraphicsSceneMouseEvent *event) {
     auto delta = event->scenePos() - event->lastScenePos();
     QRectF rec = rect();
 
-    if (state == State::Dragging) {
+    if (mstate == State::Dragging) {
         rec.moveTopLeft(rec.topLeft() + delta);
     }
 
-    if (state * State::ResizeHorizontal) {
-        if (state * State::ResizeLeft) {
+    if (mstate * State::ResizeHorizontal) {
+        if (mstate * State::ResizeLeft) {
             rec.setLeft(rec.left() + delta.x());
         } else {
             rec.setRight(rec.right() + delta.x());
         }
         if (rec.width() < 0) {
-            state ^= State::ResizeLeft;
+            mstate ^= State::ResizeLeft;
         }
     }
 
-    if (state * State::ResizeVertical) {
-        if (state * State::ResizeTop) {
+    if (mstate * State::ResizeVertical) {
+        if (mstate * State::ResizeTop) {
             rec.setTop(rec.top() + delta.y());
         } else {
             rec.setBottom(rec.bottom() + delta.y());
         }
         if (rec.height() < 0) {
-            state ^= State::ResizeTop;
+            mstate ^= State::ResizeTop;
         }
     }
 
     setRect(rec.normalized());
+    commit();
 }
 
 void Obstacle::hoverEnterEvent(QGraphicsSceneHoverEvent *event) {
@@ -192,25 +210,25 @@ void Obstacle::hoverLeaveEvent(QGraphicsSceneHoverEvent *event) {
 void Obstacle::setResizeCursor(QGraphicsSceneHoverEvent *event) {
     constexpr qreal R_BORDER = BORDER_THICKNESS / 2;
 
-    state = State::None;
+    mstate = State::None;
 
     auto relPos = event->scenePos() - rect().topLeft();
 
     if (relPos.x() <= R_BORDER) {
-        state |= State::ResizeHorizontal | State::ResizeLeft;
+        mstate |= State::ResizeHorizontal | State::ResizeLeft;
     } else if (rect().width() - relPos.x() <= R_BORDER) {
-        state |= State::ResizeHorizontal;
+        mstate |= State::ResizeHorizontal;
     }
 
     if (relPos.y() <= R_BORDER) {
-        state |= State::ResizeVertical | State::ResizeTop;
+        mstate |= State::ResizeVertical | State::ResizeTop;
     } else if (rect().height() - relPos.y() <= R_BORDER) {
-        state |= State::ResizeVertical;
+        mstate |= State::ResizeVertical;
     }
 
     #pragma GCC diagnostic push
     #pragma GCC diagnostic ignored "-Wswitch"
-    switch (state) {
+    switch (mstate) {
         case State::ResizeHorizontal
             | State::ResizeVertical
             | State::ResizeLeft
@@ -242,4 +260,10 @@ void Obstacle::setResizeCursor(QGraphicsSceneHoverEvent *event) {
     QGraphicsRectItem::hoverEnterEvent(event);
 }
 
+void Obstacle::commit() {
+    if (sim) {
+        sim->set_obstacle(idx, state());
+    }
+}
+
 }
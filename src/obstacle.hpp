@@ -9,9 +9,12 @@
 #include <QRectF>
 #include <QGraphicsRectItem>
 #include <QCursor>
+#include <cstddef>
 #include <fstream>
 
 #include "scene_obj.hpp"
+#include "simulation.hpp"
+#include "world.hpp"
 
 namespace icp {
 
@@ -57,6 +60,19 @@ public:
      */
     bool is_grabbed() const;
 
+    /**
+     * @brief Binds the obstacle to its state in the simulation. All changes
+     * to the obstacle are then sent to the simulation.
+     * @param sim The simulation with the obstacle or `nullptr` to unbind.
+     * @param idx Index of the obstacle in the simulated world.
+     */
+    void bind(Simulation *sim, std::size_t idx);
+
+    /**
+     * @brief Gets the simulation state of the obstacle.
+     */
+    ObstacleState state() const;
+
 protected:
     void selection_event(bool selected) override;
 
@@ -70,8 +86,11 @@ protected:
 
 private:
     void setResizeCursor(QGraphicsSceneHoverEvent *event);
+    void commit();
 
-    State state;
+    State mstate;
+    Simulation *sim;
+    std::size_t idx;
 };
 
 } // namespace icp
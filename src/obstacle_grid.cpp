@@ -0,0 +1,218 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Uniform grid of the edges of the obstacles. (source file)
+ */
+
+#include "obstacle_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "world.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/**
+ * @brief The smallest size of a cell.
+ */
+constexpr double MIN_CELL_SIZE = 16;
+
+/**
+ * @brief The cells are enlarged so that there are at most this many of them.
+ */
+constexpr double MAX_CELLS = 1 << 22;
+
+/**
+ * @brief The cells are enlarged so that there are about this many cells
+ * between two obstacles (by the average area per obstacle).
+ */
+constexpr double SPACING_CELLS = 2;
+
+/**
+ * @brief Marks the end of a list of entries.
+ */
+constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+ObstacleGrid::ObstacleGrid() :
+    mcell_size(MIN_CELL_SIZE),
+    mcols(0),
+    mrows(0),
+    heads(),
+    entries(),
+    free_entry(NO_ENTRY)
+{}
+
+void ObstacleGrid::build(
+    const vector<ObstacleState> &obstacles,
+    double width,
+    double height
+) {
+    // sparse obstacles don't need small cells
+    size_t count = 0;
+    for (auto &o : obstacles) {
+        count += !o.grabbed;
+    }
+    auto spacing = sqrt(width * height / max<size_t>(count, 1));
+    mcell_size = max({
+        MIN_CELL_SIZE,
+        sqrt(width * height / MAX_CELLS),
+        spacing / SPACING_CELLS,
+    });
+
+    mcols = max<size_t>(1, ceil(width / mcell_size));
+    mrows = max<size_t>(1, ceil(height / mcell_size));
+    heads.assign(mcols * mrows, NO_ENTRY);
+    entries.clear();
+    free_entry = NO_ENTRY;
+
+    for (auto &o : obstacles) {
+        if (o.grabbed) {
+            continue;
+        }
+        for_each_edge_cell(o.hitbox, [&](size_t c) {
+            entries.push_back(Entry{ o.hitbox, heads[c] });
+            heads[c] = entries.size() - 1;
+        });
+    }
+}
+
+void ObstacleGrid::add(Rect hitbox) {
+    for_each_edge_cell(hitbox, [&](size_t c) {
+        uint32_t e;
+        if (free_entry != NO_ENTRY) {
+            e = free_entry;
+            free_entry = entries[e].next;
+        } else {
+            e = entries.size();
+            entries.emplace_back();
+        }
+        entries[e] = Entry{ hitbox, heads[c] };
+        heads[c] = e;
+    });
+}
+
+void ObstacleGrid::remove(Rect hitbox) {
+    // obstacles with the same hitbox are interchangeable
+    auto same = [&](const Rect &r) {
+        return r.x == hitbox.x && r.y == hitbox.y
+            && r.w == hitbox.w && r.h == hitbox.h;
+    };
+
+    for_each_edge_cell(hitbox, [&](size_t c) {
+        for (auto *e = &heads[c]; *e != NO_ENTRY; e = &entries[*e].next) {
+            if (same(entries[*e].hitbox)) {
+                auto removed = *e;
+                *e = entries[removed].next;
+                entries[removed].next = free_entry;
+                free_entry = removed;
+                break;
+            }
+        }
+    });
+}
+
+bool ObstacleGrid::has_edges(size_t cell) const {
+    return heads[cell] != NO_ENTRY;
+}
+
+double ObstacleGrid::ray_distance(
+    const ObstacleTree &tree,
+    Vec2 p,
+    Vec2 d,
+    double max
+) const {
+    Ray ray{ p, d, 0, 0, 0 };
+    if (!find_cell(ray)) {
+        return tree.ray_distance(p, d, max);
+    }
+
+    auto best = max;
+    while (ray.t < best) {
+        best = test_cell(ray, best);
+        if (!next_cell(ray) && ray.t < best) {
+            // the rest of the 'ray' is outside of the room
+            return ray.t + tree.ray_distance(p + d * ray.t, d, best - ray.t);
+        }
+    }
+
+    return best;
+}
+
+bool ObstacleGrid::find_cell(Ray &ray) const {
+    auto q = ray.p + ray.d * ray.t;
+    if (q.x < 0 || q.x > mcols * mcell_size
+        || q.y < 0 || q.y > mrows * mcell_size
+    ) {
+        return false;
+    }
+
+    ray.x = min(size_t(q.x / mcell_size), mcols - 1);
+    ray.y = min(size_t(q.y / mcell_size), mrows - 1);
+    return true;
+}
+
+double ObstacleGrid::test_cell(const Ray &ray, double best) const {
+    auto e = heads[ray.y * mcols + ray.x];
+    for (; e != NO_ENTRY; e = entries[e].next) {
+        best = min(best, rect_distance(ray.p, ray.d, entries[e].hitbox));
+    }
+    return best;
+}
+
+bool ObstacleGrid::next_cell(Ray &ray) const {
+    auto &p = ray.p;
+    auto &d = ray.d;
+    auto tx = d.x > 0 ? ((ray.x + 1) * mcell_size - p.x) / d.x
+        : d.x < 0 ? (ray.x * mcell_size - p.x) / d.x : INFINITY;
+    auto ty = d.y > 0 ? ((ray.y + 1) * mcell_size - p.y) / d.y
+        : d.y < 0 ? (ray.y * mcell_size - p.y) / d.y : INFINITY;
+
+    // rounding must not move the 'ray' back
+    ray.t = max(ray.t, min(tx, ty));
+    if (tx < ty) {
+        return d.x > 0 ? ++ray.x < mcols : ray.x-- > 0;
+    }
+    return d.y > 0 ? ++ray.y < mrows : ray.y-- > 0;
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+template<typename F>
+void ObstacleGrid::for_each_edge_cell(Rect r, F f) const {
+    if (r.right() < 0 || r.bottom() < 0
+        || r.left() > mcols * mcell_size || r.top() > mrows * mcell_size
+    ) {
+        return;
+    }
+
+    auto cell = [&](double v, size_t count) {
+        return min(size_t(max(v, 0.) / mcell_size), count - 1);
+    };
+    auto x0 = cell(r.left(), mcols);
+    auto y0 = cell(r.top(), mrows);
+    auto x1 = cell(r.right(), mcols);
+    auto y1 = cell(r.bottom(), mrows);
+    for (auto y = y0; y <= y1; ++y) {
+        for (auto x = x0; x <= x1; ++x) {
+            // skip the cells strictly inside of the rectangle
+            auto inside = x * mcell_size > r.left()
+                && (x + 1) * mcell_size < r.right()
+                && y * mcell_size > r.top()
+                && (y + 1) * mcell_size < r.bottom();
+            if (!inside) {
+                f(y * mcols + x);
+            }
+        }
+    }
+}
+
+} // namespace icp
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Uniform grid of the edges of the obstacles. (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry.hpp"
+#include "obstacle_tree.hpp"
+
+namespace icp {
+
+struct ObstacleState;
+
+/**
+ * @brief Uniform grid over the room where each cell has the list of the
+ * obstacles whose edges cross it. A 'ray' walks the cells along its
+ * direction (DDA) and stops in the first cell where it hits an edge, so the
+ * cost depends on the length of the 'ray' and not on the number of
+ * obstacles. Obstacles can be added and removed without rebuilding it.
+ */
+class ObstacleGrid {
+public:
+    /**
+     * @brief Position of a 'ray' walking the cells.
+     */
+    struct Ray {
+        /** @brief Start of the 'ray'. */
+        Vec2 p;
+        /** @brief Unit direction of the 'ray'. */
+        Vec2 d;
+        /** @brief Distance from the start where the current cell starts. */
+        double t;
+        /** @brief Column of the current cell. */
+        std::size_t x;
+        /** @brief Row of the current cell. */
+        std::size_t y;
+    };
+
+    /**
+     * @brief Creates empty grid.
+     */
+    ObstacleGrid();
+
+    /**
+     * @brief Puts the obstacles to the cells. Grabbed obstacles are skipped.
+     * The size of the cells is chosen by the size of the room and by the
+     * number of the obstacles.
+     * @param obstacles Obstacles in the room.
+     * @param width Width of the room.
+     * @param height Height of the room.
+     */
+    void build(
+        const std::vector<ObstacleState> &obstacles,
+        double width,
+        double height
+    );
+
+    /**
+     * @brief Adds obstacle with the given hitbox.
+     */
+    void add(Rect hitbox);
+
+    /**
+     * @brief Removes obstacle with the given hitbox.
+     */
+    void remove(Rect hitbox);
+
+    /**
+     * @brief Gets the size of a cell.
+     */
+    double cell_size() const { return mcell_size; }
+
+    /**
+     * @brief Gets the number of columns of the cells.
+     */
+    std::size_t cols() const { return mcols; }
+
+    /**
+     * @brief Gets the number of rows of the cells.
+     */
+    std::size_t rows() const { return mrows; }
+
+    /**
+     * @brief Checks whether any edge crosses the cell.
+     * @param cell Index of the cell (`y * cols() + x`).
+     */
+    bool has_edges(std::size_t cell) const;
+
+    /**
+     * @brief Calculates the distance of the closest obstacle from a point in
+     * the given direction. The result is the same as with
+     * `ObstacleTree::ray_distance` up to rounding.
+     * @param tree Tree built from the same obstacles. It is used only for
+     * points outside of the room.
+     * @param p Point from which to calculate the distance.
+     * @param d Unit direction from the point ('ray').
+     * @param max Only obstacles closer than this are considered.
+     * @return The distance. `max` if no obstacle is closer.
+     */
+    double ray_distance(
+        const ObstacleTree &tree,
+        Vec2 p,
+        Vec2 d,
+        double max
+    ) const;
+
+    /**
+     * @brief Finds the cell at the distance `ray.t` along the 'ray'.
+     * @return `false` if the point is outside of the grid.
+     */
+    bool find_cell(Ray &ray) const;
+
+    /**
+     * @brief Tests the 'ray' against the obstacles in its current cell.
+     * @param ray The 'ray'.
+     * @param best Distance of the closest obstacle found so far.
+     * @return The distance of the closest obstacle.
+     */
+    double test_cell(const Ray &ray, double best) const;
+
+    /**
+     * @brief Moves the 'ray' to the next cell in its direction.
+     * @return `false` if the 'ray' left the grid.
+     */
+    bool next_cell(Ray &ray) const;
+
+private:
+    /** @brief Obstacle in the list of a cell. */
+    struct Entry {
+        Rect hitbox;
+        /** @brief Next entry in the same cell (or in the free list). */
+        std::uint32_t next;
+    };
+
+    // calls `f(cell)` for each cell crossed by an edge of the rectangle
+    template<typename F> void for_each_edge_cell(Rect r, F f) const;
+
+    double mcell_size;
+    std::size_t mcols;
+    std::size_t mrows;
+    /** @brief First entry of each cell. */
+    std::vector<std::uint32_t> heads;
+    std::vector<Entry> entries;
+    /** @brief First unused entry. */
+    std::uint32_t free_entry;
+};
+
+} // namespace icp
@@ -0,0 +1,268 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Bounding volume hierarchy over the obstacles. (source file)
+ */
+
+#include "obstacle_tree.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "world.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/**
+ * @brief Maximum number of obstacles in a leaf of the tree.
+ */
+constexpr uint32_t LEAF_SIZE = 4;
+
+/**
+ * @brief Calculates the distance at which a 'ray' enters a rectangle (slab
+ * method).
+ * @param r The rectangle.
+ * @param p Start of the 'ray'.
+ * @param d Direction of the 'ray'.
+ * @return Distance where the 'ray' enters the rectangle, 0 if it starts
+ * inside and INFINITY if it misses it.
+ */
+static double entry_distance(const Rect &r, Vec2 p, Vec2 d) {
+    double tmin = 0;
+    double tmax = INFINITY;
+
+    if (d.x == 0) {
+        if (p.x < r.left() || p.x > r.right()) {
+            return INFINITY;
+        }
+    } else {
+        auto t1 = (r.left() - p.x) / d.x;
+        auto t2 = (r.right() - p.x) / d.x;
+        tmin = max(tmin, min(t1, t2));
+        tmax = min(tmax, max(t1, t2));
+    }
+
+    if (d.y == 0) {
+        if (p.y < r.top() || p.y > r.bottom()) {
+            return INFINITY;
+        }
+    } else {
+        auto t1 = (r.top() - p.y) / d.y;
+        auto t2 = (r.bottom() - p.y) / d.y;
+        tmin = max(tmin, min(t1, t2));
+        tmax = min(tmax, max(t1, t2));
+    }
+
+    return tmin <= tmax ? tmin : INFINITY;
+}
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+ObstacleTree::ObstacleTree()
+    : nodes(), lefts(), tops(), rights(), bottoms(), ids() {}
+
+void ObstacleTree::build(const vector<ObstacleState> &obstacles) {
+    nodes.clear();
+    lefts.clear();
+    tops.clear();
+    rights.clear();
+    bottoms.clear();
+    ids.clear();
+
+    for (size_t i = 0; i < obstacles.size(); ++i) {
+        if (!obstacles[i].grabbed) {
+            ids.push_back(i);
+        }
+    }
+
+    if (ids.empty()) {
+        return;
+    }
+
+    nodes.reserve(ids.size() / LEAF_SIZE * 2 + 1);
+    nodes.push_back(Node{});
+    build_node(obstacles, 0, 0, ids.size());
+
+    lefts.reserve(ids.size());
+    tops.reserve(ids.size());
+    rights.reserve(ids.size());
+    bottoms.reserve(ids.size());
+    for (auto id : ids) {
+        auto &h = obstacles[id].hitbox;
+        lefts.push_back(h.left());
+        tops.push_back(h.top());
+        rights.push_back(h.right());
+        bottoms.push_back(h.bottom());
+    }
+}
+
+double ObstacleTree::ray_distance(Vec2 p, Vec2 d, double max) const {
+    if (nodes.empty()) {
+        return max;
+    }
+
+    auto best = max;
+    uint32_t stack[64];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top) {
+        auto &n = nodes[stack[--top]];
+        if (entry_distance(n.box, p, d) > best) {
+            continue;
+        }
+
+        if (n.count) {
+            best = min(best, rect_distance_packed(
+                p,
+                d,
+                lefts.data() + n.first,
+                tops.data() + n.first,
+                rights.data() + n.first,
+                bottoms.data() + n.first,
+                n.count
+            ));
+            continue;
+        }
+
+        // visit the closer child first so that the other may be skipped
+        auto l = entry_distance(nodes[n.first].box, p, d);
+        auto r = entry_distance(nodes[n.first + 1].box, p, d);
+        if (l <= r) {
+            stack[top++] = n.first + 1;
+            stack[top++] = n.first;
+        } else {
+            stack[top++] = n.first;
+            stack[top++] = n.first + 1;
+        }
+    }
+
+    return best;
+}
+
+void ObstacleTree::ray_distances(
+    Vec2 p,
+    const Vec2 *d,
+    double *dists,
+    size_t count
+) const {
+    if (nodes.empty()) {
+        return;
+    }
+
+    // squared distance of the point from a box, the same for all the 'rays'
+    auto box_distance = [&](const Rect &r) {
+        auto dx = max({ r.left() - p.x, 0., p.x - r.right() });
+        auto dy = max({ r.top() - p.y, 0., p.y - r.bottom() });
+        return dx * dx + dy * dy;
+    };
+
+    uint32_t stack[64];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top) {
+        auto &n = nodes[stack[--top]];
+
+        if (n.count) {
+            for (size_t i = 0; i < count; ++i) {
+                if (entry_distance(n.box, p, d[i]) > dists[i]) {
+                    continue;
+                }
+                dists[i] = min(dists[i], rect_distance_packed(
+                    p,
+                    d[i],
+                    lefts.data() + n.first,
+                    tops.data() + n.first,
+                    rights.data() + n.first,
+                    bottoms.data() + n.first,
+                    n.count
+                ));
+            }
+            continue;
+        }
+
+        size_t i = 0;
+        while (i < count && entry_distance(n.box, p, d[i]) > dists[i]) {
+            ++i;
+        }
+        if (i == count) {
+            continue;
+        }
+
+        // visit the closer child first so that the other may be skipped
+        auto l = box_distance(nodes[n.first].box);
+        auto r = box_distance(nodes[n.first + 1].box);
+        if (l <= r) {
+            stack[top++] = n.first + 1;
+            stack[top++] = n.first;
+        } else {
+            stack[top++] = n.first;
+            stack[top++] = n.first + 1;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+void ObstacleTree::build_node(
+    const vector<ObstacleState> &obstacles,
+    uint32_t node,
+    uint32_t first,
+    uint32_t count
+) {
+    auto end = ids.begin() + first + count;
+
+    // bounding box of the obstacles and of their centers
+    double l = INFINITY, t = INFINITY, r = -INFINITY, b = -INFINITY;
+    double cl = INFINITY, ct = INFINITY, cr = -INFINITY, cb = -INFINITY;
+    for (auto i = ids.begin() + first; i != end; ++i) {
+        auto &h = obstacles[*i].hitbox;
+        l = min(l, h.left());
+        t = min(t, h.top());
+        r = max(r, h.right());
+        b = max(b, h.bottom());
+
+        auto c = h.center();
+        cl = min(cl, c.x);
+        ct = min(ct, c.y);
+        cr = max(cr, c.x);
+        cb = max(cb, c.y);
+    }
+    nodes[node].box = Rect{ l, t, r - l, b - t };
+
+    if (count <= LEAF_SIZE) {
+        nodes[node].first = first;
+        nodes[node].count = count;
+        return;
+    }
+
+    // split by the median along the longer axis
+    auto half = count / 2;
+    auto mid = ids.begin() + first + half;
+    if (cr - cl >= cb - ct) {
+        nth_element(ids.begin() + first, mid, end, [&](auto a, auto b) {
+            return obstacles[a].hitbox.center().x
+                < obstacles[b].hitbox.center().x;
+        });
+    } else {
+        nth_element(ids.begin() + first, mid, end, [&](auto a, auto b) {
+            return obstacles[a].hitbox.center().y
+                < obstacles[b].hitbox.center().y;
+        });
+    }
+
+    uint32_t child = nodes.size();
+    nodes[node].first = child;
+    nodes[node].count = 0;
+    nodes.push_back(Node{});
+    nodes.push_back(Node{});
+    build_node(obstacles, child, first, half);
+    build_node(obstacles, child + 1, first + half, count - half);
+}
+
+} // namespace icp
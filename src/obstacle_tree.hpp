@@ -0,0 +1,129 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Bounding volume hierarchy over the obstacles. (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry.hpp"
+
+namespace icp {
+
+struct ObstacleState;
+
+/**
+ * @brief Static tree of axis aligned bounding boxes over the hitboxes of the
+ * obstacles. It has to be rebuilt whenever any obstacle changes.
+ */
+class ObstacleTree {
+public:
+    /**
+     * @brief Creates empty tree.
+     */
+    ObstacleTree();
+
+    /**
+     * @brief Builds the tree from the obstacles. Grabbed obstacles are
+     * skipped.
+     */
+    void build(const std::vector<ObstacleState> &obstacles);
+
+    /**
+     * @brief Calls `f(idx)` for each obstacle whose hitbox overlaps or
+     * touches the given area.
+     */
+    template<typename F> void query(Rect area, F f) const {
+        if (nodes.empty()) {
+            return;
+        }
+
+        std::uint32_t stack[64];
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while (top) {
+            auto &n = nodes[stack[--top]];
+            if (!overlaps(n.box, area)) {
+                continue;
+            }
+            if (n.count) {
+                for (auto i = n.first; i < n.first + n.count; ++i) {
+                    if (lefts[i] <= area.right() && area.left() <= rights[i]
+                        && tops[i] <= area.bottom() && area.top() <= bottoms[i]
+                    ) {
+                        f(ids[i]);
+                    }
+                }
+            } else {
+                stack[top++] = n.first;
+                stack[top++] = n.first + 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Calculates the distance of the closest obstacle from a point in
+     * the given direction.
+     * @param p Point from which to calculate the distance.
+     * @param d Unit direction from the point ('ray').
+     * @param max Only obstacles closer than this are considered.
+     * @return The distance. `max` if no obstacle is closer.
+     */
+    double ray_distance(Vec2 p, Vec2 d, double max) const;
+
+    /**
+     * @brief Calculates the distances of the closest obstacles from a point
+     * in many directions at once. The tree is traversed only once for all
+     * the 'rays' and each node is skipped when none of them can hit anything
+     * closer in it. The results are the same as with `ray_distance`.
+     * @param p Point from which to calculate the distances.
+     * @param d Unit directions from the point ('rays').
+     * @param dists On input the maximum distance for each 'ray' (only
+     * obstacles closer than it are considered), on output the distances.
+     * @param count Number of the 'rays'.
+     */
+    void ray_distances(
+        Vec2 p,
+        const Vec2 *d,
+        double *dists,
+        std::size_t count
+    ) const;
+
+private:
+    struct Node {
+        /** @brief Bounding box of all the obstacles in the node. */
+        Rect box;
+        /** @brief First child (inner node) or first hitbox (leaf). */
+        std::uint32_t first;
+        /** @brief Number of hitboxes in leaf, 0 for inner nodes. */
+        std::uint32_t count;
+    };
+
+    static bool overlaps(const Rect &a, const Rect &b) {
+        return a.left() <= b.right() && b.left() <= a.right()
+            && a.top() <= b.bottom() && b.top() <= a.bottom();
+    }
+
+    void build_node(
+        const std::vector<ObstacleState> &obstacles,
+        std::uint32_t node,
+        std::uint32_t first,
+        std::uint32_t count
+    );
+
+    std::vector<Node> nodes;
+    // Hitboxes of the obstacles in the order of the leaves, packed by edges so
+    // that a whole leaf can be tested at once with `rect_distance_packed`.
+    std::vector<double> lefts;
+    std::vector<double> tops;
+    std::vector<double> rights;
+    std::vector<double> bottoms;
+    /** @brief Indexes of the obstacles in the packed hitboxes. */
+    std::vector<std::uint32_t> ids;
+};
+
+} // namespace icp
@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Measures how long do the phases of the simulation take. (source
+ * file)
+ */
+
+#include "profiler.hpp"
+
+#include <algorithm>
+
+namespace icp {
+
+using namespace std;
+
+const char *phase_name(Phase phase) {
+    switch (phase) {
+        case Phase::Move:
+            return "move";
+        case Phase::Border:
+            return "border";
+        case Phase::Obstacles:
+            return "obstacles";
+        case Phase::Robots:
+            return "robots";
+        case Phase::Sync:
+            return "sync";
+        case Phase::Paint:
+            return "paint";
+    }
+    return "";
+}
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+void Profiler::add(Phase phase, double seconds) {
+    auto &s = samples[static_cast<size_t>(phase)];
+    s.durations[s.next] = seconds;
+    s.next = (s.next + 1) % WINDOW;
+    s.len = min(s.len + 1, WINDOW);
+}
+
+void Profiler::lap(Phase phase, Clock::time_point &start) {
+    auto end = now();
+    add(phase, chrono::duration<double>(end - start).count());
+    start = end;
+}
+
+PhaseStats Profiler::stats(Phase phase) const {
+    auto &s = samples[static_cast<size_t>(phase)];
+    PhaseStats res;
+    res.count = s.len;
+    if (s.len == 0) {
+        return res;
+    }
+
+    array<double, WINDOW> sorted;
+    auto end = copy_n(s.durations.begin(), s.len, sorted.begin());
+
+    res.min = *min_element(sorted.begin(), end);
+    double sum = 0;
+    for (auto d = sorted.begin(); d != end; ++d) {
+        sum += *d;
+    }
+    res.avg = sum / s.len;
+
+    auto p99 = sorted.begin() + (s.len - 1) * 99 / 100;
+    nth_element(sorted.begin(), p99, end);
+    res.p99 = *p99;
+
+    return res;
+}
+
+Profile Profiler::profile() const {
+    Profile res;
+    for (size_t i = 0; i < PHASE_COUNT; ++i) {
+        res[i] = stats(static_cast<Phase>(i));
+    }
+    return res;
+}
+
+} // namespace icp
@@ -0,0 +1,112 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Measures how long do the phases of the simulation take. (header
+ * file)
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace icp {
+
+/**
+ * @brief Measured part of the simulation.
+ */
+enum class Phase {
+    /** @brief Moving the robots (including their distance from obstacles). */
+    Move,
+    /** @brief Collisions of the robots with the border of the room. */
+    Border,
+    /** @brief Collisions of the robots with the obstacles. */
+    Obstacles,
+    /** @brief Collisions of the robots with each other. */
+    Robots,
+    /** @brief Updating the items in the scene from the simulation. */
+    Sync,
+    /** @brief Painting the scene. */
+    Paint,
+};
+
+/**
+ * @brief Number of the values of `Phase`.
+ */
+constexpr std::size_t PHASE_COUNT = 6;
+
+/**
+ * @brief Gets the name of the phase as it is shown to the user.
+ */
+const char *phase_name(Phase phase);
+
+/**
+ * @brief Statistics of the recent durations of a phase (in seconds).
+ */
+struct PhaseStats {
+    double min = 0;
+    double avg = 0;
+    /** @brief 99th percentile. */
+    double p99 = 0;
+    /** @brief Number of the durations from which the stats are calculated. */
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Statistics of all the phases indexed by `Phase`.
+ */
+using Profile = std::array<PhaseStats, PHASE_COUNT>;
+
+/**
+ * @brief Keeps the last `WINDOW` durations of each phase.
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Number of the durations kept for each phase.
+     */
+    static constexpr std::size_t WINDOW = 256;
+
+    /**
+     * @brief Gets the current time for `lap`.
+     */
+    static Clock::time_point now() { return Clock::now(); }
+
+    /**
+     * @brief Adds duration of phase.
+     * @param phase The measured phase.
+     * @param seconds Duration of the phase in seconds.
+     */
+    void add(Phase phase, double seconds);
+
+    /**
+     * @brief Adds the time since `start` as duration of the phase and sets
+     * `start` to the current time, so that the next phase can be measured.
+     */
+    void lap(Phase phase, Clock::time_point &start);
+
+    /**
+     * @brief Calculates the statistics of the recent durations of the phase.
+     */
+    PhaseStats stats(Phase phase) const;
+
+    /**
+     * @brief Calculates the statistics of all the phases. Phases without
+     * durations have zero `count`.
+     */
+    Profile profile() const;
+
+private:
+    struct Samples {
+        std::array<double, WINDOW> durations{};
+        std::size_t len = 0;
+        std::size_t next = 0;
+    };
+
+    std::array<Samples, PHASE_COUNT> samples;
+};
+
+} // namespace icp
@@ -0,0 +1,189 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief History of the recent ticks with bounded memory. (source file)
+ */
+
+#include "rewind.hpp"
+
+#include <algorithm>
+
+namespace icp {
+
+using namespace std;
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+RewindBuffer::RewindBuffer(size_t budget, uint64_t keyframe) :
+    mbudget(budget),
+    keyframe_len(max<uint64_t>(keyframe, 1)),
+    segments(),
+    mmemory(0),
+    coder()
+{}
+
+void RewindBuffer::set_budget(size_t budget) {
+    mbudget = budget;
+    shrink();
+}
+
+void RewindBuffer::clear() {
+    segments.clear();
+    mmemory = 0;
+}
+
+void RewindBuffer::record(const World &world, bool changed) {
+    auto tick = world.ticks();
+    if (!segments.empty()) {
+        auto &key = segments.back().key;
+        // the history must be continuous and must be able to show the
+        // robots of the current world
+        if (tick < segments.back().last()
+            || tick > segments.back().last() + 1
+            || key.robots.size() != world.robots().size()
+            || key.obstacles.size() != world.obstacles().size())
+        {
+            clear();
+        }
+    }
+
+    if (segments.empty()
+        || changed
+        || tick == segments.back().last()
+        || segments.back().frames.size() + 1 >= keyframe_len)
+    {
+        start_segment(world);
+    } else {
+        encode(world.robots());
+    }
+    shrink();
+}
+
+uint64_t RewindBuffer::first() const {
+    return segments.empty() ? 0 : segments.front().key.ticks;
+}
+
+uint64_t RewindBuffer::last() const {
+    return segments.empty() ? 0 : segments.back().last();
+}
+
+bool RewindBuffer::positions(
+    uint64_t tick,
+    vector<double> &x,
+    vector<double> &y,
+    vector<double> &angle
+) const {
+    auto seg = find(tick);
+    if (!seg) {
+        return false;
+    }
+
+    auto &key = seg->key.robots;
+    auto frames = tick - seg->key.ticks;
+    if (frames == 0) {
+        x = key.x;
+        y = key.y;
+        angle = key.angle;
+        return true;
+    }
+
+    TrackCoder dec;
+    dec.reset(key);
+    auto p = seg->data.data();
+    auto end = p + seg->data.size();
+    for (uint64_t f = 0; f < frames; ++f) {
+        dec.decode(p, end);
+    }
+    dec.get(x, y, angle);
+    return true;
+}
+
+const WorldState *RewindBuffer::keyframe(uint64_t tick) const {
+    auto seg = find(tick);
+    return seg ? &seg->key : nullptr;
+}
+
+void RewindBuffer::truncate(uint64_t tick) {
+    while (!segments.empty() && segments.back().key.ticks > tick) {
+        mmemory -= segments.back().memory();
+        segments.pop_back();
+    }
+    if (segments.empty() || segments.back().last() <= tick) {
+        return;
+    }
+
+    auto &seg = segments.back();
+    mmemory -= seg.memory();
+    auto frames = tick - seg.key.ticks;
+    seg.data.resize(seg.frames[frames]);
+    seg.frames.resize(frames);
+    mmemory += seg.memory();
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+size_t RewindBuffer::Segment::memory() const {
+    return sizeof(Segment)
+        + key.obstacles.size() * sizeof(ObstacleState)
+        + key.robots.size() * RobotArrays::robot_size()
+        + data.size()
+        + frames.size() * sizeof(size_t);
+}
+
+const RewindBuffer::Segment *RewindBuffer::find(uint64_t tick) const {
+    // the newest segment that starts before the tick, when the world was
+    // changed, the segment after the change starts at the same tick as the
+    // previous one ends
+    auto seg = upper_bound(
+        segments.begin(),
+        segments.end(),
+        tick,
+        [](uint64_t t, const Segment &s) { return t < s.key.ticks; }
+    );
+    if (seg == segments.begin() || tick > (--seg)->last()) {
+        return nullptr;
+    }
+    return &*seg;
+}
+
+void RewindBuffer::start_segment(const World &world) {
+    // the keyframe would be shown instead of the previous one anyway
+    if (!segments.empty()
+        && segments.back().frames.empty()
+        && segments.back().key.ticks == world.ticks())
+    {
+        mmemory -= segments.back().memory();
+        segments.pop_back();
+    }
+
+    size_t reserve = segments.empty() ? 0 : segments.back().data.size();
+    segments.push_back(Segment{ world.state(), {}, {} });
+    auto &seg = segments.back();
+    seg.data.reserve(reserve);
+    seg.frames.reserve(keyframe_len);
+    mmemory += seg.memory();
+    coder.reset(seg.key.robots);
+}
+
+void RewindBuffer::encode(const RobotArrays &robots) {
+    auto &seg = segments.back();
+    mmemory -= seg.memory();
+
+    seg.frames.push_back(seg.data.size());
+    coder.encode(robots, seg.data);
+
+    mmemory += seg.memory();
+}
+
+void RewindBuffer::shrink() {
+    while (mmemory > mbudget && segments.size() > 1) {
+        mmemory -= segments.front().memory();
+        segments.pop_front();
+    }
+}
+
+} // namespace icp
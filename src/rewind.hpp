@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief History of the recent ticks with bounded memory. (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "track_coder.hpp"
+#include "world.hpp"
+
+namespace icp {
+
+/**
+ * @brief Default memory budget of the rewind history in bytes.
+ */
+constexpr std::size_t REWIND_BUDGET = 256 * 1024 * 1024;
+
+/**
+ * @brief Default number of ticks between two keyframes of the rewind
+ * history.
+ */
+constexpr std::uint64_t REWIND_KEYFRAME = 100;
+
+/**
+ * @brief Recent history of the world. It is split into segments, each of
+ * them starts with keyframe (complete state of the world) followed by the
+ * positions and angles of the robots in the next ticks encoded by
+ * `TrackCoder`, so robots that move straight take only a byte per value. When
+ * the history takes more memory than the budget, the oldest segments are
+ * dropped.
+ *
+ * The decoded positions are only for showing the history. The exact state
+ * of the world at any tick in the history is the keyframe of its segment
+ * simulated for the remaining ticks (see `keyframe`), a new segment is
+ * started whenever the world is changed by other means than tick.
+ */
+class RewindBuffer {
+public:
+    /**
+     * @brief Creates empty history.
+     * @param budget Maximum memory taken by the history in bytes (at least
+     * the newest segment is always kept).
+     * @param keyframe Number of ticks between two keyframes.
+     */
+    RewindBuffer(
+        std::size_t budget = REWIND_BUDGET,
+        std::uint64_t keyframe = REWIND_KEYFRAME
+    );
+
+    /**
+     * @brief Gets the maximum memory taken by the history in bytes.
+     */
+    std::size_t budget() const { return mbudget; }
+
+    /**
+     * @brief Sets the maximum memory taken by the history in bytes. Old
+     * segments are dropped if the history is over the budget.
+     */
+    void set_budget(std::size_t budget);
+
+    /**
+     * @brief Gets the memory taken by the history in bytes (approximately).
+     */
+    std::size_t memory() const { return mmemory; }
+
+    /**
+     * @brief Removes all the history.
+     */
+    void clear();
+
+    /**
+     * @brief Adds the current state of the world to the history. It is
+     * called after each tick and after each change of the world.
+     * @param world The world to record.
+     * @param changed `true` if the world was changed by other means than
+     * tick. History with different number of robots or obstacles is
+     * removed.
+     */
+    void record(const World &world, bool changed = false);
+
+    /**
+     * @brief Checks whether there is any history.
+     */
+    bool empty() const { return segments.empty(); }
+
+    /**
+     * @brief Gets the oldest tick in the history.
+     */
+    std::uint64_t first() const;
+
+    /**
+     * @brief Gets the newest tick in the history.
+     */
+    std::uint64_t last() const;
+
+    /**
+     * @brief Decodes the positions and angles of the robots at the given
+     * tick. The positions are rounded to `TrackCoder::POS_STEP` and the
+     * angles to `TrackCoder::ANGLE_STEP`.
+     * @param tick The tick (between `first` and `last`).
+     * @param x Left edges of the hitboxes of the robots.
+     * @param y Top edges of the hitboxes of the robots.
+     * @param angle Angles of the robots.
+     * @return `false` if the tick is not in the history.
+     */
+    bool positions(
+        std::uint64_t tick,
+        std::vector<double> &x,
+        std::vector<double> &y,
+        std::vector<double> &angle
+    ) const;
+
+    /**
+     * @brief Gets the keyframe from which the world at the given tick is
+     * simulated. The world restored from it and ticked until the tick is
+     * the same as the world at the tick was.
+     * @return The keyframe or `nullptr` if the tick is not in the history.
+     */
+    const WorldState *keyframe(std::uint64_t tick) const;
+
+    /**
+     * @brief Removes the history after the given tick.
+     */
+    void truncate(std::uint64_t tick);
+
+private:
+    struct Segment {
+        /** @brief State of the world at the first tick of the segment. */
+        WorldState key;
+        /** @brief Encoded ticks after the keyframe. */
+        std::vector<unsigned char> data;
+        /** @brief Start of each tick in `data`. */
+        std::vector<std::size_t> frames;
+
+        std::uint64_t last() const { return key.ticks + frames.size(); }
+        std::size_t memory() const;
+    };
+
+    const Segment *find(std::uint64_t tick) const;
+    void start_segment(const World &world);
+    void encode(const RobotArrays &robots);
+    void shrink();
+
+    std::size_t mbudget;
+    std::uint64_t keyframe_len;
+    std::deque<Segment> segments;
+    std::size_t mmemory;
+
+    // encodes the ticks of the newest segment
+    TrackCoder coder;
+};
+
+} // namespace icp
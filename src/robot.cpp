@@ -14,18 +14,36 @@
 #include <QGraphicsSceneHoverEvent>
 #include <QCursor>
 
+#include "auto_robot.hpp"
+#include "control_robot.hpp"
+#include "convert.hpp"
+
 namespace icp {
 
 using namespace std;
 
-/**
- * @brief Diameter of the robot.
- */
-constexpr qreal ROBOT_DIAMETER = 50;
 /**
  * @brief Thickness of the border around the robot.
  */
 constexpr qreal BORDER_THICKNESS = 6;
+/**
+ * @brief Diameter of the robot (without the border).
+ */
+constexpr qreal BODY_DIAMETER = ROBOT_DIAMETER - BORDER_THICKNESS;
+/**
+ * @brief Difference between the hitbox and the visual rectangle.
+ */
+constexpr qreal ADJ = BORDER_THICKNESS / 2;
+
+/**
+ * @brief Moves the robot state to the given position.
+ * @param state State to move.
+ * @param position Top-left corner of the bounding square of the robot.
+ */
+static RobotState at_position(RobotState state, QPointF position) {
+    state.hitbox.move_top_left(to_vec(position - QPointF(ADJ, ADJ)));
+    return state;
+}
 
 //---------------------------------------------------------------------------//
 //                                  PUBLIC                                   //
@@ -44,11 +62,20 @@ Robot::Robot(
     qreal angle,
     qreal speed,
     QObject *parent
-) :
-    QGraphicsEllipseItem(
-        QRectF(position, QSizeF(ROBOT_DIAMETER, ROBOT_DIAMETER))
-    ),
-    grabbed(false)
+) : Robot(position, RobotState::dummy(Vec2{ 0, 0 }, angle, speed), parent) {}
+
+Robot::Robot(Robot *other) : Robot(
+    other->rect().topLeft(),
+    other->rstate.angle,
+    other->rstate.mspeed,
+    other->parent()
+) {}
+
+Robot::Robot(RobotState state, QObject *parent) :
+    QGraphicsEllipseItem(),
+    rstate(state),
+    sim(nullptr),
+    idx(0)
 {
     setBrush(QBrush(QColor(0xcc, 0x55, 0xcc)));
     setPen(QPen(QColor(0xff, 0xff, 0xff), BORDER_THICKNESS));
@@ -60,45 +87,56 @@ Robot::Robot(
     );
     eye->setBrush(QBrush(QColor(0xff, 0xff, 0xff)));
     eye->setPen(QPen(QColor(0, 0, 0, 0)));
-    set_angle(angle);
-    set_speed(speed);
+    update_rect();
 }
 
-Robot::Robot(Robot *other) : Robot(
-    other->rect().topLeft(),
-    other->angle,
-    other->mspeed,
-    other->parent()
-) {}
+Robot *Robot::from_state(const RobotState &state) {
+    switch (state.kind) {
+        case RobotKind::Auto:
+            return new AutoRobot(state);
+        case RobotKind::Control:
+            return new ControlRobot(state);
+        default:
+            return new Robot(state);
+    }
+}
 
-void Robot::move(qreal delta, qreal distance) {
-    move_by(step() * delta);
+void Robot::bind(Simulation *sim, size_t idx) {
+    this->sim = sim;
+    this->idx = idx;
+}
+
+void Robot::sync(const RobotState &state, Vec2 pos) {
+    auto em = rstate.angle != state.angle;
+    rstate = state;
+    update_rect(pos);
+    if (em) {
+        emit angle_change(rstate.angle);
+    }
 }
 
 QRectF Robot::hitbox() const {
-    constexpr qreal ADJ = BORDER_THICKNESS / 2;
     return rect().adjusted(-ADJ, -ADJ, ADJ, ADJ);
 }
 
 void Robot::set_hitbox(QRectF hitbox) {
-    constexpr qreal ADJ = BORDER_THICKNESS / 2;
     move_to(hitbox.topLeft() + QPointF(ADJ, ADJ));
 }
 
 QPointF Robot::step() {
-    return orientation_vec() * mspeed;
+    return orientation_vec() * rstate.mspeed;
 }
 
 qreal Robot::orientation() {
-    return angle;
+    return rstate.angle;
 }
 
 QPointF Robot::orientation_vec() {
-    return QPointF(cos(angle), sin(angle));
+    return to_qpoint(rstate.orientation_vec());
 }
 
 qreal Robot::speed() {
-    return mspeed;
+    return rstate.speed();
 }
 
 void Robot::set_step(QPointF step) {
@@ -107,15 +145,14 @@ void Robot::set_step(QPointF step) {
 }
 
 void Robot::set_angle(qreal angle) {
-    auto em = this->angle != angle;
-    this->angle = angle;
-    auto e = eye->rect();
-    e.moveCenter(
-        rect().center() + orientation_vec() * (ROBOT_DIAMETER / 3)
-    );
-    eye->setRect(e);
+    auto em = rstate.angle != angle;
+    rstate.set_angle(angle);
+    if (sim) {
+        sim->set_robot_angle(idx, angle);
+    }
+    update_rect();
     if (em) {
-        emit angle_change(this->angle);
+        emit angle_change(rstate.angle);
     }
 }
 
@@ -132,25 +169,25 @@ qreal Robot::get_mod_angle(unsigned mod) {
 }
 
 void Robot::set_speed(qreal speed) {
-    mspeed = speed;
-}
-
-void Robot::save(ofstream &file) {
-    auto ang = get_mod_angle(360);
-    if (ang < -180) {
-        ang += 360;
+    rstate.set_speed(speed);
+    if (sim) {
+        sim->set_robot_speed(idx, speed);
     }
-
-    file << "robot: [" << hitbox().x() << ", " << hitbox().y() << "] { speed: "
-        << mspeed << ", angle: " << ang << " }" << endl;
-
-    
 }
 
 //---------------------------------------------------------------------------//
 //                                PROTECTED                                  //
 //---------------------------------------------------------------------------//
 
+Robot::Robot(QPointF position, RobotState state, QObject *parent) :
+    Robot(at_position(state, position), parent) {}
+
+void Robot::commit_params() {
+    if (sim) {
+        sim->set_robot_params(idx, rstate);
+    }
+}
+
 void Robot::selection_event(bool selected) {
     if (selected) {
         setPen(QPen(QColor(0xff, 0xff, 0x55), BORDER_THICKNESS));
@@ -164,7 +201,10 @@ void Robot::mousePressEvent(QGraphicsSceneMouseEvent *event) {
     set_selected();
 
     if (event->button() & Qt::LeftButton) {
-        grabbed = true;
+        rstate.grabbed = true;
+        if (sim) {
+            sim->set_robot_grabbed(idx, true);
+        }
         grabMouse();
         hover_mouse();
     }
@@ -173,7 +213,10 @@ void Robot::mousePressEvent(QGraphicsSceneMouseEvent *event) {
 void Robot::mouseReleaseEvent(QGraphicsSceneMouseEvent *event) {
     setZValue(0);
     if (event->button() & Qt::LeftButton) {
-        grabbed = false;
+        rstate.grabbed = false;
+        if (sim) {
+            sim->set_robot_grabbed(idx, false);
+        }
         ungrabMouse();
         hover_mouse();
     }
@@ -202,7 +245,7 @@ void Robot::hoverLeaveEvent(QGraphicsSceneHoverEvent *event) {
 //---------------------------------------------------------------------------//
 
 void Robot::hover_mouse() {
-    if (grabbed) {
+    if (rstate.grabbed) {
         setCursor(Qt::ClosedHandCursor);
     } else {
         setCursor(Qt::OpenHandCursor);
@@ -214,12 +257,27 @@ void Robot::move_by(QPointF delta) {
 }
 
 void Robot::move_to(QPointF point) {
-    auto rec = rect();
-    rec.moveTopLeft(point);
+    rstate.hitbox.move_top_left(to_vec(point - QPointF(ADJ, ADJ)));
+    if (sim) {
+        sim->move_robot(idx, rstate.hitbox.top_left());
+    }
+    update_rect();
+}
+
+void Robot::update_rect() {
+    update_rect(rstate.hitbox.top_left());
+}
+
+void Robot::update_rect(Vec2 pos) {
+    auto box = rstate.hitbox;
+    box.move_top_left(pos);
+    auto rec = to_qrect(box).adjusted(ADJ, ADJ, -ADJ, -ADJ);
     setRect(rec);
 
     // ensure that the eye of the robot is updated
-    set_angle(angle);
+    auto e = eye->rect();
+    e.moveCenter(rec.center() + orientation_vec() * (BODY_DIAMETER / 3));
+    eye->setRect(e);
 }
 
 }
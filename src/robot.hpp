@@ -10,11 +10,14 @@
 #define _USE_MATH_DEFINES
 
 #include <cmath>
+#include <cstddef>
 #include <fstream>
 
 #include <QGraphicsEllipseItem>
 
 #include "scene_obj.hpp"
+#include "simulation.hpp"
+#include "world.hpp"
 
 namespace icp {
 
@@ -54,18 +57,43 @@ public:
     explicit Robot(Robot *other);
 
     /**
-     * @brief Moves the robot. The robot must also support 'unmove' of the one
-     * last move when delta is negative.
-     * @param delta Elapsed time in seconds since last tick.
-     * @param distance Distance to the closest obstacle in the direction of the
-     * robot.
+     * @brief Creates a new robot from its simulation state.
+     * @param state The simulation state of the robot.
+     * @param parent Parent object.
+     */
+    explicit Robot(RobotState state, QObject *parent = nullptr);
+
+    /**
+     * @brief Creates robot of the type given by the kind of the state.
+     * @param state The simulation state of the robot.
      */
-    virtual void move(qreal delta, qreal distance);
+    static Robot *from_state(const RobotState &state);
 
     /**
      * @brief Checks whether the robot is grabbed.
      */
-    inline bool is_grabbed() const { return grabbed; }
+    inline bool is_grabbed() const { return rstate.grabbed; }
+
+    /**
+     * @brief Gets the simulation state of the robot.
+     */
+    inline const RobotState &state() const { return rstate; }
+
+    /**
+     * @brief Binds the robot to its state in the simulation. All changes to
+     * the robot are then sent to the simulation.
+     * @param sim The simulation with the robot or `nullptr` to unbind.
+     * @param idx Index of the robot in the simulated world.
+     */
+    void bind(Simulation *sim, std::size_t idx);
+
+    /**
+     * @brief Updates the robot from its simulated state.
+     * @param state State of the robot in snapshot of the world.
+     * @param pos Where to show the robot (top-left corner of the hitbox). It
+     * may differ from the simulated position when it is interpolated.
+     */
+    void sync(const RobotState &state, Vec2 pos);
 
     /**
      * @brief Gets the visual bounding box.
@@ -97,7 +125,7 @@ public:
     /**
      * @brief Gets the movement speed.
      */
-    virtual qreal speed();
+    qreal speed();
 
     /**
      * @brief Sets the angle and speed so that it matches the given step.
@@ -126,13 +154,8 @@ public:
      * @brief Sets the robot movement speed.
      * @param speed Speed of the robot in pixels per second.
      */
-    virtual void set_speed(qreal speed);
+    void set_speed(qreal speed);
 
-    /**
-     * @brief Saves robot to the file
-     * @param file file to save robot into
-     */
-    virtual void save(std::ofstream &file);
 
 signals:
     /**
@@ -142,6 +165,26 @@ signals:
     void angle_change(qreal angle);
 
 protected:
+    /**
+     * @brief Creates a new robot with the given state.
+     * @param position Top-left corner of the bounding square of the robot.
+     * @param state Simulation state of the robot (its position is ignored).
+     * @param parent Parent object.
+     */
+    explicit Robot(
+        QPointF position,
+        RobotState state,
+        QObject *parent = nullptr
+    );
+
+    /**
+     * @brief Sends the parameters of the behaviour of the robot to the
+     * simulation if it is bound (see `World::set_robot_params`). Its
+     * position and orientation in the simulation are kept, they may have
+     * changed since the last sync.
+     */
+    void commit_params();
+
     void selection_event(bool selected) override;
 
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
@@ -152,15 +195,20 @@ protected:
     void hoverMoveEvent(QGraphicsSceneHoverEvent *event) override;
     void hoverLeaveEvent(QGraphicsSceneHoverEvent *event) override;
 
+    /**
+     * @brief The simulation state of the robot.
+     */
+    RobotState rstate;
+
 private:
     void hover_mouse();
     void move_by(QPointF delta);
     void move_to(QPointF pos);
+    void update_rect();
+    void update_rect(Vec2 pos);
 
-    qreal angle;
-    qreal mspeed;
-
-    bool grabbed;
+    Simulation *sim;
+    std::size_t idx;
     QGraphicsEllipseItem *eye;
 };
 
@@ -0,0 +1,167 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Uniform grid for finding robots that may collide. (source file)
+ */
+
+#include "robot_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "world.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/**
+ * @brief Marks robot that is not in the grid.
+ */
+constexpr uint32_t NO_CELL = UINT32_MAX;
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+RobotGrid::RobotGrid(double cell_size) :
+    cell_size(cell_size),
+    cols(1),
+    rows(1),
+    cell_start(),
+    items(),
+    robot_cell()
+{}
+
+void RobotGrid::build(
+    const RobotArrays &robots,
+    double width,
+    double height
+) {
+    cols = max<size_t>(1, ceil(width / cell_size));
+    rows = max<size_t>(1, ceil(height / cell_size));
+
+    // counting sort of the robots by their cells
+    cell_start.assign(cols * rows + 1, 0);
+    robot_cell.resize(robots.size());
+    uint32_t count = 0;
+    for (size_t i = 0; i < robots.size(); ++i) {
+        if (robots.grabbed[i]) {
+            robot_cell[i] = NO_CELL;
+            continue;
+        }
+        auto r = robots.radius[i];
+        auto c = cell_of(Vec2{ robots.x[i] + r, robots.y[i] + r });
+        robot_cell[i] = c;
+        ++cell_start[c];
+        ++count;
+    }
+
+    // `cell_start[c]` is now the end of the cell `c`
+    for (size_t c = 1; c < cell_start.size(); ++c) {
+        cell_start[c] += cell_start[c - 1];
+    }
+
+    // iterate backwards so that the robots in a cell stay sorted
+    items.resize(count);
+    for (size_t i = robots.size(); i-- > 0;) {
+        if (robot_cell[i] != NO_CELL) {
+            items[--cell_start[robot_cell[i]]] = i;
+        }
+    }
+}
+
+double RobotGrid::ray_distance(
+    const RobotArrays &robots,
+    size_t skip,
+    Vec2 p,
+    Vec2 d,
+    double max
+) const {
+    if (items.empty()) {
+        return max;
+    }
+
+    auto best = max;
+    auto test_cell = [&](size_t c) {
+        for (auto a = cell_start[c]; a < cell_start[c + 1]; ++a) {
+            auto i = items[a];
+            if (i == skip) {
+                continue;
+            }
+            auto r = robots.radius[i];
+            Vec2 center{ robots.x[i] + r, robots.y[i] + r };
+            best = min(best, circle_distance(p, d, center, r));
+        }
+    };
+
+    // The robot may be hit only in the cells around the cell of its center,
+    // so the neighbours of each cell along the 'ray' are tested. After a
+    // step only the row or column of the neighbours that is new is tested.
+    auto start = cell_of(p);
+    size_t x = start % cols;
+    size_t y = start / cols;
+    auto test_row = [&](size_t ny) {
+        auto x0 = x ? x - 1 : 0;
+        auto x1 = min(x + 1, cols - 1);
+        for (auto nx = x0; nx <= x1; ++nx) {
+            test_cell(ny * cols + nx);
+        }
+    };
+    auto test_col = [&](size_t nx) {
+        auto y0 = y ? y - 1 : 0;
+        auto y1 = min(y + 1, rows - 1);
+        for (auto ny = y0; ny <= y1; ++ny) {
+            test_cell(ny * cols + nx);
+        }
+    };
+
+    for (auto ny = y ? y - 1 : 0; ny <= min(y + 1, rows - 1); ++ny) {
+        test_row(ny);
+    }
+
+    double t = 0;
+    while (true) {
+        // move to the next cell along the 'ray'
+        auto tx = d.x > 0 ? ((x + 1) * cell_size - p.x) / d.x
+            : d.x < 0 ? (x * cell_size - p.x) / d.x : INFINITY;
+        auto ty = d.y > 0 ? ((y + 1) * cell_size - p.y) / d.y
+            : d.y < 0 ? (y * cell_size - p.y) / d.y : INFINITY;
+        t = std::max(t, min(tx, ty));
+        if (t >= best) {
+            break;
+        }
+
+        if (tx < ty) {
+            if (d.x > 0 ? ++x == cols : x-- == 0) {
+                break;
+            }
+            auto nx = d.x > 0 ? x + 1 : x - 1;
+            if (nx < cols) {
+                test_col(nx);
+            }
+        } else {
+            if (d.y > 0 ? ++y == rows : y-- == 0) {
+                break;
+            }
+            auto ny = d.y > 0 ? y + 1 : y - 1;
+            if (ny < rows) {
+                test_row(ny);
+            }
+        }
+    }
+
+    return best;
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+size_t RobotGrid::cell_of(Vec2 p) const {
+    auto x = clamp(floor(p.x / cell_size), 0., cols - 1.);
+    auto y = clamp(floor(p.y / cell_size), 0., rows - 1.);
+    return (size_t)y * cols + (size_t)x;
+}
+
+} // namespace icp
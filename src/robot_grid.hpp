@@ -0,0 +1,129 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Uniform grid for finding robots that may collide. (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry.hpp"
+
+namespace icp {
+
+struct RobotArrays;
+
+/**
+ * @brief Uniform grid over the room with cells of the size of a robot. Robots
+ * can collide only if they are in the same or neighbouring cells.
+ */
+class RobotGrid {
+public:
+    /**
+     * @brief Creates empty grid.
+     * @param cell_size Size of a single cell. Must be at least the diameter
+     * of the largest robot.
+     */
+    RobotGrid(double cell_size);
+
+    /**
+     * @brief Sorts the robots into the cells. Grabbed robots are skipped.
+     * Robots outside of the room are put to the nearest border cell.
+     * @param robots Robots to put to the grid.
+     * @param width Width of the room.
+     * @param height Height of the room.
+     */
+    void build(
+        const RobotArrays &robots,
+        double width,
+        double height
+    );
+
+    /**
+     * @brief Calls `f(i, j)` exactly once for each pair of robot indexes
+     * `i < j` that are in the same or neighbouring cells.
+     */
+    template<typename F> void for_each_pair(F f) const {
+        for (std::size_t y = 0; y < rows; ++y) {
+            for (std::size_t x = 0; x < cols; ++x) {
+                auto c = y * cols + x;
+                for (auto a = cell_start[c]; a < cell_start[c + 1]; ++a) {
+                    // rest of the same cell
+                    for (auto b = a + 1; b < cell_start[c + 1]; ++b) {
+                        call_pair(f, items[a], items[b]);
+                    }
+                    // half of the neighbours so that each pair is visited
+                    // only once
+                    if (x + 1 < cols) {
+                        call_cell(f, items[a], c + 1);
+                    }
+                    if (y + 1 < rows) {
+                        if (x > 0) {
+                            call_cell(f, items[a], c + cols - 1);
+                        }
+                        call_cell(f, items[a], c + cols);
+                        if (x + 1 < cols) {
+                            call_cell(f, items[a], c + cols + 1);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Calculates the distance of the closest robot from a point in
+     * the given direction. The robots are circles with the radius
+     * `RobotArrays::radius` around the centers of their hitboxes. Only the
+     * cells along the 'ray' and their neighbours are checked.
+     * @param robots Robots from which the grid was built (with the same
+     * positions).
+     * @param skip Index of robot that is not considered (e.g. the robot that
+     * casts the 'ray').
+     * @param p Point from which to calculate the distance.
+     * @param d Unit direction from the point ('ray').
+     * @param max Only robots closer than this are considered.
+     * @return The distance. `max` if no robot is closer.
+     */
+    double ray_distance(
+        const RobotArrays &robots,
+        std::size_t skip,
+        Vec2 p,
+        Vec2 d,
+        double max
+    ) const;
+
+private:
+    template<typename F>
+    static void call_pair(F &f, std::uint32_t a, std::uint32_t b) {
+        if (a < b) {
+            f(a, b);
+        } else {
+            f(b, a);
+        }
+    }
+
+    template<typename F>
+    void call_cell(F &f, std::uint32_t a, std::size_t c) const {
+        for (auto b = cell_start[c]; b < cell_start[c + 1]; ++b) {
+            call_pair(f, a, items[b]);
+        }
+    }
+
+    std::size_t cell_of(Vec2 p) const;
+
+    double cell_size;
+    std::size_t cols;
+    std::size_t rows;
+    /** @brief Index to `items` where each cell starts (one extra at end). */
+    std::vector<std::uint32_t> cell_start;
+    /** @brief Robot indexes sorted by cell. */
+    std::vector<std::uint32_t> items;
+    /** @brief Cell of each robot (`NO_CELL` for skipped robots). */
+    std::vector<std::uint32_t> robot_cell;
+};
+
+} // namespace icp
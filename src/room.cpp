@@ -6,176 +6,200 @@
 
 #include "room.hpp"
 
-#include <memory>
+#include <chrono>
 #include <cmath>
+#include <limits>
+#include <memory>
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
+#include <QMessageBox>
 #include <QPointer>
 #include <QTimerEvent>
 #include <QKeyEvent>
-#include <QMessageBox>
 
 #include "auto_robot.hpp"
 #include "control_robot.hpp"
+#include "convert.hpp"
 
 namespace icp {
 
 using namespace std;
 
 /**
- * @brief How often should the robots update their position.
- */
-constexpr chrono::milliseconds TICK_LEN = chrono::milliseconds(10);
-/**
- * @brief How often should the robots update their position. (in seconds)
+ * @brief How often is the room redrawn. The positions of the robots are
+ * interpolated so it doesn't have to match the length of tick.
  */
-constexpr qreal TICK_DELTA = TICK_LEN.count()
-    * decltype(TICK_LEN)::period::num
-    / static_cast<qreal>(decltype(TICK_LEN)::period::den);
+constexpr chrono::milliseconds FRAME_LEN(16);
 
-/**
- * @brief Checks if value is in range.
- * @param val Value to check.
- * @param start Smaller value in the range.
- * @param end Larger value in the range.
- * @return true if value is in the range, otherwise false.
- */
-bool in_range(qreal val, qreal start, qreal end) {
-    return val > start && val < end;
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+Room::Room(QObject *parent) :
+    QGraphicsScene(parent),
+    sim(),
+    obstacles(),
+    timer(0),
+    selected(nullptr),
+    shown_ticks(0),
+    shown_commands(0),
+    seeking(false),
+    replay(),
+    replay_running(false),
+    replay_failed(false),
+    replay_pos(0),
+    replay_time(chrono::steady_clock::now()),
+    replay_tick(numeric_limits<uint64_t>::max()),
+    replay_seg(0),
+    replay_robots(),
+    profiler(),
+    world_profile(),
+    paint_start()
+{
+    setBackgroundBrush(QBrush(QColor(0x22, 0x22, 0x22)));
+    connect(this, &Room::sceneRectChanged, this, &Room::resize_world);
+    timer = startTimer(FRAME_LEN, Qt::PreciseTimer);
 }
 
-/**
- * @brief Checks if point is in circle.
- * @param radius Radius of the circle.
- * @param center Center of the circle.
- * @param point Point to check.
- * @return true if point is in circle, otherwise false.
- */
-bool in_circle(qreal radius, QPointF center, QPointF point) {
-    auto dist = center - point;
-    return dist.x() * dist.x() + dist.y() * dist.y() < radius * radius;
+Room::Room(World world, QObject *parent) : Room(parent) {
+    sim.restore(world.state());
+    add_items(world.obstacles(), world.robots());
 }
 
-/**
- * @brief Calculates the discriminant of a 2x2 matrix.
- * @param a First row.
- * @param b Second row.
- */
-qreal cross(QPointF a, QPointF b) {
-    return a.x() * b.y() - a.y() * b.x();
+Room::Room(unique_ptr<TrajectoryReader> trajectory, QObject *parent) :
+    Room(parent)
+{
+    // the simulation only holds the size of the room
+    sim.set_running(false);
+    replay = std::move(trajectory);
+    replay_pos = replay->first();
+
+    auto &key = replay->keyframe();
+    add_items(key.obstacles, key.robots);
+    replay_seg = replay->segment();
+    replay_robots = key.robots;
 }
 
-/**
- * @brief Calculates a point where two lines intersect.
- * @param p1 Point trough which the first line passes.
- * @param d1 Direction in which the first line goes.
- * @param p2 Point trough which the second line passes.
- * @param d2 Direction in which the second line goes.
- * @return The intersection point.
- */
-QPointF line_intersection(QPointF p1, QPointF d1, QPointF p2, QPointF d2) {
-    auto u = cross(p2 - p1, d1) / cross(d1, d2);
-    return p2 + u * d2;
+void Room::add_obstacle(unique_ptr<Obstacle> obstacle) {
+    Obstacle *obst = obstacle.release();
+    sim.add_obstacle(obst->state());
+    add_obstacle_item(obst, obstacles.size());
 }
 
-/**
- * @brief Calculates the distance of a segment from a given point in the given
- * direction.
- * @param p Point from which the segment distance is calculated.
- * @param d Direction of the 'ray'.
- * @param a First point of the segment (x or y must be smaller than b).
- * @param b Second point of the segment (x or y must be larger than b).
- * @return Distance of the segment from the point. INFINITY when the 'ray'
- * doesn't touch the segment.
- */
-qreal segment_distance(QPointF p, QPointF d, QPointF a, QPointF b) {
-    auto is = line_intersection(p, d, a, a - b);
-    if (isnan(is.x())
-        || isnan(is.y())
-        || (!in_range(is.x(), a.x(), b.x()) && !in_range(is.y(), a.y(), b.y()))
-    ) {
-        return Q_INFINITY;
+void Room::add_robot(unique_ptr<Robot> robot) {
+    Robot *rob = robot.release();
+    sim.add_robot(rob->state());
+    add_robot_item(rob, robots.size());
+}
+
+Profile Room::profile() const {
+    auto res = world_profile;
+    for (auto phase : { Phase::Sync, Phase::Paint }) {
+        auto idx = static_cast<size_t>(phase);
+        res[idx] = profiler.stats(phase);
     }
-    auto v = is - p;
-    if (QPointF::dotProduct(d, v) < 0) {
-        return Q_INFINITY;
+    return res;
+}
+
+shared_ptr<const WorldState> Room::capture() {
+    if (replay) {
+        return make_shared<const WorldState>(replay_state());
     }
 
-    return sqrt(v.x() * v.x() + v.y() * v.y());
+    shared_ptr<const WorldState> res;
+    sim.call([&](const World &w) {
+        res = make_shared<const WorldState>(w.state());
+    });
+    return res;
 }
 
-/**
- * @brief Calculates the distance of a rectangle from a point in the given
- * direction.
- * @param p Point from which to calculate the distance.
- * @param d Direction from the point ('ray').
- * @param r Rectangle to calculate the distance from.
- * @return Distance from the rectangle. INFINITY if the 'ray' doesn't touch the
- * rectangle.
- */
-qreal rect_distance(QPointF p, QPointF d, QRectF r) {
-    return min({
-        segment_distance(p, d, r.topLeft(), r.topRight()),
-        segment_distance(p, d, r.topRight(), r.bottomRight()),
-        segment_distance(p, d, r.bottomLeft(), r.bottomRight()),
-        segment_distance(p, d, r.topLeft(), r.bottomLeft())
-    });
+void Room::set_rewind_budget(size_t bytes) {
+    sim.set_rewind_budget(bytes);
 }
 
-//---------------------------------------------------------------------------//
-//                                  PUBLIC                                   //
-//---------------------------------------------------------------------------//
+void Room::set_deterministic(bool deterministic) {
+    sim.set_deterministic(deterministic);
+}
 
-Room::Room(QObject *parent) :
-    QGraphicsScene(parent),
-    obstacles(),
-    timer(0),
-    selected(nullptr)
-{
-    setBackgroundBrush(QBrush(QColor(0x22, 0x22, 0x22)));
-    timer = startTimer(TICK_LEN, Qt::PreciseTimer);
+void Room::set_sensing(Sensing sensing) {
+    sim.set_sensing(sensing);
 }
 
-void Room::add_obstacle(unique_ptr<Obstacle> obstacle) {
-    Obstacle *obst = obstacle.release();
-    addItem(obst);
-    obstacles.push_back(obst);
-    connect(
-        obst,
-        &Obstacle::select,
-        this,
-        &Room::select_obj
-    );
+void Room::set_robot_sensing(bool sensing) {
+    sim.set_robot_sensing(sensing);
 }
 
-void Room::add_robot(unique_ptr<Robot> robot) {
-    Robot *rob = robot.release();
-    addItem(rob);
-    robots.push_back(rob);
-    connect(
-        rob,
-        &Robot::select,
-        this,
-        &Room::select_obj
-    );
+void Room::set_input_log(shared_ptr<InputLogWriter> log) {
+    if (!replay) {
+        sim.set_input_log(std::move(log));
+    }
+}
+
+void Room::start_recording(const string &filename) {
+    if (replay) {
+        throw runtime_error("Replay cannot be recorded");
+    }
+    sim.start_recording(filename);
+}
+
+void Room::stop_recording() {
+    sim.stop_recording();
+}
+
+void Room::restore(const WorldState &state) {
+    if (replay) {
+        return;
+    }
+    seeking = false;
+    remove_items();
+    sim.restore(state);
+    add_items(state.obstacles, state.robots);
 }
 
 //---------------------------------------------------------------------------//
 //                               PUBLIC SLOTS                                //
 //---------------------------------------------------------------------------//
 void Room::run_simulation(bool play) {
-    if (play) {
-        if (!timer) {
-            timer = startTimer(TICK_LEN, Qt::PreciseTimer);
+    if (replay) {
+        replay_running = play;
+        replay_time = chrono::steady_clock::now();
+        if (!play) {
+            emit rate_change(0);
         }
-    } else {
-        killTimer(timer);
-        timer = 0;
+        return;
     }
+
+    if (play && seeking) {
+        // the world may be different at the tick, show it as it was
+        auto state = sim.rewind();
+        if (state) {
+            remove_items();
+            add_items(state->obstacles, state->robots);
+        }
+        seeking = false;
+    }
+    sim.set_running(play);
+}
+
+void Room::seek(uint64_t tick) {
+    if (replay) {
+        replay_pos = tick;
+        return;
+    }
+    seeking = true;
+    sim.seek(tick);
+}
+
+void Room::set_time_scale(double scale) {
+    sim.set_time_scale(scale);
 }
 
 void Room::remove_obj(SceneObj *o) {
+    if (replay) {
+        return;
+    }
     auto obj = unique_ptr<SceneObj>(o);
     if (o == selected) {
         select_obj(NULL);
@@ -189,9 +213,23 @@ void Room::remove_obj(SceneObj *o) {
         }
 
         removeItem(rob);
-
-        swap(*p, *robots.rbegin());
-        robots.pop_back();
+        rob->bind(nullptr, 0);
+
+        size_t idx = p - robots.begin();
+        sim.remove_robot(idx);
+        if (sim.is_deterministic()) {
+            // the world keeps the order of the robots
+            robots.erase(p);
+            for (auto i = idx; i < robots.size(); ++i) {
+                robots[i]->bind(&sim, i);
+            }
+        } else {
+            swap(*p, *robots.rbegin());
+            robots.pop_back();
+            if (idx < robots.size()) {
+                robots[idx]->bind(&sim, idx);
+            }
+        }
     }
 
     auto obs = dynamic_cast<Obstacle *>(o);
@@ -202,14 +240,30 @@ void Room::remove_obj(SceneObj *o) {
         }
 
         removeItem(obs);
-
-        swap(*p, *obstacles.rbegin());
-        obstacles.pop_back();
+        obs->bind(nullptr, 0);
+
+        size_t idx = p - obstacles.begin();
+        sim.remove_obstacle(idx);
+        if (sim.is_deterministic()) {
+            obstacles.erase(p);
+            for (auto i = idx; i < obstacles.size(); ++i) {
+                obstacles[i]->bind(&sim, i);
+            }
+        } else {
+            swap(*p, *obstacles.rbegin());
+            obstacles.pop_back();
+            if (idx < obstacles.size()) {
+                obstacles[idx]->bind(&sim, idx);
+            }
+        }
     }
 }
 
 void Room::change_robot(Robot *old, Robot *replace) {
     auto rep = unique_ptr<Robot>(replace);
+    if (replay) {
+        return;
+    }
     auto sel = selected;
 
     remove_obj(old);
@@ -221,48 +275,75 @@ void Room::change_robot(Robot *old, Robot *replace) {
 }
 
 void Room::add_obstacle_slot(Obstacle *obstacle) {
-    add_obstacle(unique_ptr<Obstacle>(obstacle));
+    auto obst = unique_ptr<Obstacle>(obstacle);
+    if (!replay) {
+        add_obstacle(std::move(obst));
+    }
 }
 
 void Room::add_robot_slot(Robot *robot) {
-    add_robot(unique_ptr<Robot>(robot));
+    auto rob = unique_ptr<Robot>(robot);
+    if (!replay) {
+        add_robot(std::move(rob));
+    }
 }
 
-void Room::save(string filename) {
-    ofstream file(filename);
-    if (!file.is_open()) {
-        QMessageBox::critical(
-            nullptr,
-            "Error saving room", "File cannot be accessed"
-        );
+//---------------------------------------------------------------------------//
+//                                PROTECTED                                  //
+//---------------------------------------------------------------------------//
+
+void Room::timerEvent(QTimerEvent *event) {
+    if (replay) {
+        replay_frame();
         return;
     }
 
-    file << "room: " << width() << "x" << height() << endl;
-    for (auto obst : obstacles) {
-        file << "obstacle: " << obst->hitbox().width() << "x"
-            << obst->hitbox().height() << " [" << obst->hitbox().x() << ", "
-            << obst->hitbox().y() << "]" << endl;
+    auto snap = sim.poll();
+    if (!snap) {
+        return;
     }
 
-    for (auto rob : robots) {
-        rob->save(file);
+    auto fresh = snap->ticks != shown_ticks
+        || snap->commands != shown_commands;
+    shown_ticks = snap->ticks;
+    shown_commands = snap->commands;
+    if (fresh) {
+        world_profile = snap->profile;
+        emit rate_change(snap->rate);
+        emit history_change(
+            snap->history_first,
+            snap->history_last,
+            snap->tick
+        );
     }
-    file.close();
 
-    QMessageBox::information(
-        nullptr,
-        "Success",
-        "The room was successfully saved"
-    );
+    // interpolate only in real time, otherwise update the items only once
+    // for all the ticks since the last snapshot
+    auto interpolate = sim.time_scale() == 1;
+    if (!interpolate && !fresh) {
+        return;
+    }
+
+    auto now = chrono::steady_clock::now();
+    auto start = Profiler::now();
+    for (size_t i = 0; i < robots.size(); ++i) {
+        auto pos = interpolate
+            ? snap->position(i, now)
+            : snap->robots.hitbox(i).top_left();
+        robots[i]->sync(snap->robots.get(i), pos);
+    }
+    profiler.lap(Phase::Sync, start);
 }
 
-//---------------------------------------------------------------------------//
-//                                PROTECTED                                  //
-//---------------------------------------------------------------------------//
+void Room::drawBackground(QPainter *painter, const QRectF &rect) {
+    // the view draws the background first and the foreground last
+    paint_start = Profiler::now();
+    QGraphicsScene::drawBackground(painter, rect);
+}
 
-void Room::timerEvent(QTimerEvent *event) {
-    tick(TICK_DELTA);
+void Room::drawForeground(QPainter *painter, const QRectF &rect) {
+    QGraphicsScene::drawForeground(painter, rect);
+    profiler.lap(Phase::Paint, paint_start);
 }
 
 void Room::keyPressEvent(QKeyEvent *event) {
@@ -272,7 +353,7 @@ void Room::keyPressEvent(QKeyEvent *event) {
     }
 
     auto robot = dynamic_cast<ControlRobot *>(selected);
-    if (!robot || timer == 0)
+    if (!robot || !sim.is_running())
         return;
 
     switch (event->key()) {
@@ -290,7 +371,7 @@ void Room::keyPressEvent(QKeyEvent *event) {
 
 void Room::keyReleaseEvent(QKeyEvent *event) {
     auto robot = dynamic_cast<ControlRobot *>(selected);
-    if (!robot || timer == 0)
+    if (!robot || !sim.is_running())
         return;
 
     switch (event->key()) {
@@ -320,184 +401,146 @@ void Room::select_obj(SceneObj *o) {
     emit new_selection(selected);
 }
 
+void Room::resize_world(const QRectF &rect) {
+    sim.set_size(rect.width(), rect.height());
+}
+
 //---------------------------------------------------------------------------//
 //                                 PRIVATE                                   //
 //---------------------------------------------------------------------------//
 
-void Room::tick(qreal delta) {
-    move_robots(delta);
-
-    // collisions of robots with the border of the room
-    for (auto r : robots) {
-        if (!r->is_grabbed()) {
-            border_collision(r);
-        }
+void Room::add_items(
+    const vector<ObstacleState> &obsts,
+    const RobotArrays &robs
+) {
+    for (size_t i = 0; i < obsts.size(); ++i) {
+        auto obst = new Obstacle(to_qrect(obsts[i].hitbox));
+        obst->set_hitbox(to_qrect(obsts[i].hitbox));
+        add_obstacle_item(obst, i);
     }
 
-    // collisions of robots with obstacles
-    for (auto o : obstacles) {
-        if (o->is_grabbed()) {
-            continue;
-        }
-        for (auto r : robots) {
-            if (!r->is_grabbed()) {
-                obstacle_collision(r, o);
-            }
-        }
-    }
-
-    // collisions of robots with each other
-    auto end = robots.end();
-    for (auto r1 = robots.begin(); r1 != end; ++r1) {
-        if ((*r1)->is_grabbed()) {
-            continue;
-        }
-        for (auto r2 = r1 + 1; r2 != end; ++r2) {
-            if (!(*r2)->is_grabbed()) {
-                robot_collision(*r1, *r2);
-            }
-        }
+    for (size_t i = 0; i < robs.size(); ++i) {
+        add_robot_item(Robot::from_state(robs.get(i)), i);
     }
 }
 
-void Room::move_robots(qreal delta) {
-    for (auto r : robots) {
-        if (!r->is_grabbed()) {
-            r->move(delta, obstacle_distance(r));
-        }
+void Room::remove_items() {
+    select_obj(nullptr);
+    for (auto rob : robots) {
+        removeItem(rob);
+        delete rob;
     }
-}
-
-void Room::border_collision(Robot *rob) {
-    auto box = rob->hitbox();
-
-    if (box.left() < 0) {
-        box.moveLeft(0);
-    } else if (box.right() > width()) {
-        box.moveRight(width());
+    robots.clear();
+    for (auto obst : obstacles) {
+        removeItem(obst);
+        delete obst;
     }
+    obstacles.clear();
+}
 
-    if (box.top() < 0) {
-        box.moveTop(0);
-    } else if (box.bottom() > height()) {
-        box.moveBottom(height());
-    }
+void Room::add_obstacle_item(Obstacle *obst, size_t idx) {
+    addItem(obst);
+    // replayed items are only shown
+    obst->bind(replay ? nullptr : &sim, idx);
+    obst->setEnabled(!replay);
+    obstacles.push_back(obst);
+    connect(
+        obst,
+        &Obstacle::select,
+        this,
+        &Room::select_obj
+    );
+}
 
-    rob->set_hitbox(box);
+void Room::add_robot_item(Robot *rob, size_t idx) {
+    addItem(rob);
+    rob->bind(replay ? nullptr : &sim, idx);
+    rob->setEnabled(!replay);
+    robots.push_back(rob);
+    connect(
+        rob,
+        &Robot::select,
+        this,
+        &Room::select_obj
+    );
 }
 
-void Room::obstacle_collision(Robot *rob, Obstacle *obs) {
-    // circle (robot)
-    auto c = rob->hitbox();
-    // rectangle (obstacle)
-    auto r = obs->hitbox();
+void Room::replay_frame() {
+    using dsec = chrono::duration<double>;
 
-    // check edge overlap
-    auto center = (c.topLeft() + c.bottomRight()) / 2;
-    auto cx = center.x();
-    auto cy = center.y();
-    // horizontal edge
-    if (in_range(cx, r.left(), r.right())) {
-        // top edge of obstacle
-        if (in_range(c.bottom(), r.top(), r.bottom())) {
-            c.moveBottom(r.top());
-            rob->set_hitbox(c);
-            return;
-        }
-        // bottom edge of obstacle
-        if (in_range(c.top(), r.top(), r.bottom())) {
-            c.moveTop(r.bottom());
-            rob->set_hitbox(c);
-            return;
-        }
-        // no overlap
-        return;
-    } else if (in_range(cy, r.top(), r.bottom())) {
-        // left edge of obstacle
-        if (in_range(c.right(), r.left(), r.right())) {
-            c.moveRight(r.left());
-            rob->set_hitbox(c);
-            return;
-        }
-        // right edge of obstacle
-        if (in_range(c.left(), r.left(), r.right())) {
-            c.moveLeft(r.right());
-            rob->set_hitbox(c);
-            return;
-        }
-        // no overlap
+    if (replay_failed) {
         return;
     }
 
-    // check corner overlap
-    auto radius = c.width() / 2;
-    if (in_circle(radius, center, r.topLeft())) {
-        corner_collision(rob, r.topLeft());
-        return;
-    }
-    if (in_circle(radius, center, r.topRight())) {
-        corner_collision(rob, r.topRight());
-        return;
+    auto now = chrono::steady_clock::now();
+    if (replay_running) {
+        auto scale = sim.time_scale();
+        replay_pos = isfinite(scale)
+            ? replay_pos + dsec(now - replay_time).count() * scale / TICK_DELTA
+            : replay->last();
+        replay_pos = min(replay_pos, double(replay->last()));
     }
-    if (in_circle(radius, center, r.bottomRight())) {
-        corner_collision(rob, r.bottomRight());
+    replay_time = now;
+
+    auto start = Profiler::now();
+    uint64_t tick;
+    try {
+        tick = replay->seek(uint64_t(replay_pos));
+    } catch (const exception &e) {
+        // the robots stay shown at the last valid tick, set the flag first
+        // because the timer still runs while the message box is open
+        replay_running = false;
+        replay_failed = true;
+        emit rate_change(0);
+        QMessageBox::critical(nullptr, "Error loading room", e.what());
         return;
     }
-    if (in_circle(radius, center, r.bottomLeft())) {
-        corner_collision(rob, r.bottomLeft());
+    if (tick == replay_tick && replay->segment() == replay_seg) {
         return;
     }
-    return;
-}
-
-void Room::robot_collision(Robot *r1, Robot *r2) {
-    auto c1 = r1->hitbox();
-    auto c2 = r2->hitbox();
-    auto dir = c2.topLeft() - c1.topLeft();
-    auto cw = (c1.width() + c2.width()) / 2;
-    auto dir_len = sqrt(dir.x() * dir.x() + dir.y() * dir.y());
-    auto over = cw - dir_len;
+    replay_tick = tick;
 
-    if (over <= 0) {
-        // No collision
-        return;
+    if (replay->segment() != replay_seg) {
+        show_replay_segment();
     }
+    replay->positions(replay_robots.x, replay_robots.y, replay_robots.angle);
+    replay_robots.update_directions();
+    for (size_t i = 0; i < robots.size(); ++i) {
+        robots[i]->sync(
+            replay_robots.get(i),
+            replay_robots.hitbox(i).top_left()
+        );
+    }
+    profiler.lap(Phase::Sync, start);
 
-    dir = dir_len == 0 ? QPointF(0, 0) : dir * (over / (2 * dir_len));
-    c1.moveTopLeft(c1.topLeft() - dir);
-    c2.moveTopLeft(c2.topLeft() + dir);
-    r1->set_hitbox(c1);
-    r2->set_hitbox(c2);
-}
-
-void Room::corner_collision(Robot *rob, QPointF p) {
-    auto box = rob->hitbox();
-    auto c = (box.topLeft() + box.bottomRight()) / 2;
-    auto r = box.width() / 2;
-
-    auto mv = p - c;
-    auto ml = sqrt(mv.x() * mv.x() + mv.y() * mv.y());
-    mv = mv - mv * (r / ml);
-
-    box.moveTopLeft(box.topLeft() + mv);
-    rob->set_hitbox(box);
+    emit rate_change(replay_running ? sim.time_scale() : 0);
+    emit history_change(replay->first(), replay->last(), tick);
 }
 
-qreal Room::obstacle_distance(Robot *rob) {
-    auto r = rob->hitbox();
-    auto c = (r.topLeft() + r.bottomRight()) / 2;
-    auto d = rob->orientation_vec();
-
-    qreal res = rect_distance(c, d, QRectF(0, 0, width(), height()));
+void Room::show_replay_segment() {
+    auto &key = replay->keyframe();
+    replay_seg = replay->segment();
 
-    for (auto o : obstacles) {
-        if (!o->is_grabbed()) {
-            res = min(res, rect_distance(c, d, o->hitbox()));
+    // most of the segments only continue the previous one
+    if (key.robots.kind != replay_robots.kind
+        || key.obstacles.size() != obstacles.size())
+    {
+        remove_items();
+        add_items(key.obstacles, key.robots);
+    } else {
+        for (size_t i = 0; i < obstacles.size(); ++i) {
+            obstacles[i]->set_hitbox(to_qrect(key.obstacles[i].hitbox));
         }
     }
+    replay_robots = key.robots;
+}
 
-    return clamp(res - r.width() / 2, 0., Q_INFINITY);
+WorldState Room::replay_state() const {
+    auto res = replay->keyframe();
+    res.ticks = replay->tick();
+    replay->positions(res.robots.x, res.robots.y, res.robots.angle);
+    res.robots.update_directions();
+    return res;
 }
 
 } // namespace icp
-
@@ -6,9 +6,11 @@
 
 #pragma once
 
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <fstream>
+#include <string>
 
 #include <QGraphicsScene>
 
@@ -16,6 +18,10 @@
 #include "robot.hpp"
 #include "control_robot.hpp"
 #include "auto_robot.hpp"
+#include "profiler.hpp"
+#include "simulation.hpp"
+#include "trajectory.hpp"
+#include "world.hpp"
 
 namespace icp {
 
@@ -32,6 +38,30 @@ public:
      */
     Room(QObject *parent = nullptr);
 
+    /**
+     * @brief Creates a new room that shows the given world.
+     * @param world The simulated world.
+     * @param parent The Qt object.
+     */
+    Room(World world, QObject *parent = nullptr);
+
+    /**
+     * @brief Creates a new room that replays the recorded trajectories. The
+     * robots are only moved as they were recorded, nothing is simulated and
+     * the room cannot be edited.
+     * @param trajectory The recorded trajectories.
+     * @param parent The Qt object.
+     */
+    Room(
+        std::unique_ptr<TrajectoryReader> trajectory,
+        QObject *parent = nullptr
+    );
+
+    /**
+     * @brief Checks whether the room replays recorded trajectories.
+     */
+    bool is_replay() const { return replay != nullptr; }
+
     /**
      * @brief Adds obstacle to the room.
      * @param obstacle Obstacle to add to the room.
@@ -44,6 +74,78 @@ public:
      */
     void add_robot(std::unique_ptr<Robot> robot);
 
+    /**
+     * @brief Gets the statistics of the durations of the recent ticks (as
+     * published by the simulation), scene updates and paints.
+     */
+    Profile profile() const;
+
+    /**
+     * @brief Captures the complete state of the simulation, so that it can
+     * be later restored (e.g. to continue from checkpoint). Only the arrays
+     * of the robots and obstacles are copied, the simulation keeps running
+     * while the copy is used (e.g. saved on other thread).
+     */
+    std::shared_ptr<const WorldState> capture();
+
+    /**
+     * @brief Replaces all the robots and obstacles in the room with the
+     * captured state. The simulation continues exactly as it did after the
+     * capture.
+     */
+    void restore(const WorldState &state);
+
+    /**
+     * @brief Sets the maximum memory taken by the history to which the room
+     * can be rewound.
+     * @param bytes The memory budget in bytes.
+     */
+    void set_rewind_budget(std::size_t bytes);
+
+    /**
+     * @brief Sets deterministic mode of the simulation (see
+     * `World::set_deterministic`).
+     */
+    void set_deterministic(bool deterministic);
+
+    /**
+     * @brief Sets the algorithm used by the robots to find the closest
+     * obstacle (see `World::set_sensing`).
+     */
+    void set_sensing(Sensing sensing);
+
+    /**
+     * @brief Sets whether the robots see the other robots (see
+     * `World::set_robot_sensing`).
+     */
+    void set_robot_sensing(bool sensing);
+
+    /**
+     * @brief Starts writing the changes of the room to the input log, so
+     * that the simulation can be repeated (e.g. by `icp-robots-sim`).
+     * @param log The input log or `nullptr` to stop logging.
+     */
+    void set_input_log(std::shared_ptr<InputLogWriter> log);
+
+    /**
+     * @brief Checks whether the trajectories of the robots are recorded.
+     */
+    bool is_recording() const { return sim.is_recording(); }
+
+    /**
+     * @brief Starts recording the trajectories of the robots to the file.
+     * @param filename Path to the trajectory file.
+     * @throws std::runtime_error when the file cannot be created or the room
+     * is replay.
+     */
+    void start_recording(const std::string &filename);
+
+    /**
+     * @brief Stops recording and waits until the whole recording is written.
+     * @throws std::runtime_error when writing of the recording failed.
+     */
+    void stop_recording();
+
 signals:
     /**
      * @brief Signal for new object selection
@@ -51,13 +153,48 @@ signals:
      */
     void new_selection(SceneObj *o);
 
+    /**
+     * @brief Signal with the achieved simulation speed.
+     * @param rate Simulated seconds per real second.
+     */
+    void rate_change(double rate);
+
+    /**
+     * @brief Signal with the range of the history to which the room can be
+     * rewound.
+     * @param first The oldest tick in the history.
+     * @param last The newest tick in the history.
+     * @param tick The tick at which are the shown robots.
+     */
+    void history_change(
+        std::uint64_t first,
+        std::uint64_t last,
+        std::uint64_t tick
+    );
+
 public slots:
     /**
-     * @brief Play/pause the simulation.
+     * @brief Play/pause the simulation. When the robots are shown at tick
+     * selected by `seek`, the simulation continues from that tick.
      * @param play
      */
     void run_simulation(bool play);
 
+    /**
+     * @brief Shows the robots at the given tick of the history. It should be
+     * used only while the simulation is paused.
+     * @param tick The tick in the range given by `history_change`.
+     */
+    void seek(std::uint64_t tick);
+
+    /**
+     * @brief Sets the simulation speed. With other speed than 1 the robots
+     * aren't interpolated and are updated only when the simulation publishes
+     * new state.
+     * @param scale Simulated seconds per real second.
+     */
+    void set_time_scale(double scale);
+
     /**
      * @brief Remove object.
      * @param o object to be removed
@@ -83,36 +220,66 @@ public slots:
      */
     void add_robot_slot(Robot *robot);
 
-    /**
-     * @brief Saves room
-     * @param filename file to save the room into
-     */
-    void save(std::string filename);
 
 protected:
     void timerEvent(QTimerEvent *event) override;
 
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
+
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
 
 private slots:
     void select_obj(SceneObj *o);
+    void resize_world(const QRectF &rect);
 
 private:
-    void tick(qreal delta);
-    void move_robots(qreal delta);
-    void border_collision(Robot *rob);
-    void obstacle_collision(Robot *rob, Obstacle *obs);
-    void robot_collision(Robot *r1, Robot *r2);
-    void corner_collision(Robot *rob, QPointF p);
-    qreal obstacle_distance(Robot *rob);
+    void add_items(
+        const std::vector<ObstacleState> &obsts,
+        const RobotArrays &robs
+    );
+    void remove_items();
+    void add_obstacle_item(Obstacle *obst, std::size_t idx);
+    void add_robot_item(Robot *rob, std::size_t idx);
+    void replay_frame();
+    void show_replay_segment();
+    WorldState replay_state() const;
 
+    Simulation sim;
+    // obstacles and robots are at the same indexes as in the simulated world
     std::vector<Obstacle *> obstacles;
     std::vector<Robot *> robots;
 
     SceneObj *selected;
 
+    // refreshes the items from the simulation
     int timer;
+    // the snapshot that is shown
+    std::uint64_t shown_ticks;
+    std::uint64_t shown_commands;
+    // the robots are shown at tick selected by `seek`
+    bool seeking;
+
+    // replayed trajectories, `nullptr` if the room is simulated
+    std::unique_ptr<TrajectoryReader> replay;
+    bool replay_running;
+    // the trajectories are damaged after the shown tick
+    bool replay_failed;
+    // replayed tick including the part of the tick that already elapsed
+    double replay_pos;
+    std::chrono::steady_clock::time_point replay_time;
+    // the shown tick and segment of the trajectories
+    std::uint64_t replay_tick;
+    std::size_t replay_seg;
+    // the shown robots
+    RobotArrays replay_robots;
+
+    // durations of the phases on this thread (sync and paint)
+    Profiler profiler;
+    // durations of the phases of the simulation from the last snapshot
+    Profile world_profile;
+    Profiler::Clock::time_point paint_start;
 };
 
 } // namespace icp
@@ -0,0 +1,100 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Entry point of the converter between the text and binary room
+ * formats.
+ */
+
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "binary_room.hpp"
+#include "loader.hpp"
+#include "world.hpp"
+
+using namespace std;
+using namespace icp;
+
+/**
+ * @brief Prints the usage of the program.
+ * @param name Name of the program.
+ */
+static void print_help(const char *name) {
+    cerr << "Usage:" << endl
+        << "  " << name << " <input> <output> [options]" << endl
+        << endl
+        << "Converts room file between the text and binary format. The"
+        << " format of the input" << endl
+        << "is detected from its contents. The output is binary if it ends"
+        << " with " << BINARY_ROOM_EXT << "," << endl
+        << "otherwise it is text." << endl
+        << endl
+        << "Options:" << endl
+        << "  -b   Write the binary format regardless of the extension."
+        << endl
+        << "  -t   Write the text format regardless of the extension."
+        << endl;
+}
+
+int main(int argc, char **argv) {
+    string input;
+    string output;
+    int binary = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        auto arg = argv[i];
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            print_help(argv[0]);
+            return 0;
+        }
+
+        if (strcmp(arg, "-b") == 0) {
+            binary = 1;
+        } else if (strcmp(arg, "-t") == 0) {
+            binary = 0;
+        } else if (arg[0] == '-') {
+            cerr << "Invalid arguments: Unknown option " << arg << endl;
+            print_help(argv[0]);
+            return 1;
+        } else if (input.empty()) {
+            input = arg;
+        } else if (output.empty()) {
+            output = arg;
+        } else {
+            cerr << "Invalid arguments: Unexpected argument " << arg << endl;
+            print_help(argv[0]);
+            return 1;
+        }
+    }
+
+    if (output.empty()) {
+        print_help(argv[0]);
+        return 1;
+    }
+    if (binary == -1) {
+        binary = has_binary_room_ext(output);
+    }
+
+    World world;
+    try {
+        world = Loader(input).load();
+    } catch (const exception &e) {
+        cerr << "Error loading room: " << e.what() << endl;
+        return 1;
+    }
+
+    ofstream file(output, binary ? ios::binary : ios::out);
+    if (!file.is_open()) {
+        cerr << "Error saving room: File cannot be accessed" << endl;
+        return 1;
+    }
+
+    if (binary) {
+        save_binary_room(world, file);
+    } else {
+        world.save(file);
+    }
+}
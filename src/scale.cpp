@@ -0,0 +1,298 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Entry point of the benchmark of the simulation speed depending on
+ * the number of robots and obstacles.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "world.hpp"
+
+using namespace std;
+using namespace icp;
+
+/**
+ * @brief Parameters of the generated rooms.
+ */
+struct Config {
+    /** @brief Numbers of robots to measure. */
+    vector<size_t> robots{ 10, 100, 1000, 10000, 100000 };
+    /** @brief Numbers of obstacles to measure. */
+    vector<size_t> obstacles{ 10, 100, 1000, 10000, 50000 };
+    /** @brief Relative amounts of `Dummy`, `Auto` and `Control` robots. */
+    double mix[3]{ 1, 1, 1 };
+    /** @brief Part of the room covered by robots and obstacles. */
+    double fill = 0.1;
+    /** @brief Number of measured ticks. */
+    unsigned long long ticks = 100;
+    unsigned seed = 42;
+    /** @brief How the robots find the closest obstacle. */
+    Sensing sensing = Sensing::Tree;
+    /** @brief The robots see the other robots. */
+    bool robot_sensing = true;
+};
+
+/**
+ * @brief Generates room with randomly placed robots and obstacles. The size
+ * of the room is chosen so that they cover `conf.fill` of it.
+ * @param conf Parameters of the room.
+ * @param robots Number of robots.
+ * @param obstacles Number of obstacles.
+ */
+static World generate(const Config &conf, size_t robots, size_t obstacles) {
+    constexpr double MIN_OBST = 10;
+    constexpr double MAX_OBST = 100;
+
+    auto obst_area = (MIN_OBST + MAX_OBST) / 2 * (MIN_OBST + MAX_OBST) / 2;
+    auto area = robots * ROBOT_DIAMETER * ROBOT_DIAMETER
+        + obstacles * obst_area;
+    auto side = max(sqrt(area / conf.fill), 2 * MAX_OBST);
+
+    mt19937 rng(conf.seed);
+    uniform_real_distribution<double> obst_pos(0, side - MAX_OBST);
+    uniform_real_distribution<double> obst_size(MIN_OBST, MAX_OBST);
+    uniform_real_distribution<double> robot_pos(0, side - ROBOT_DIAMETER);
+    uniform_real_distribution<double> angle(-M_PI, M_PI);
+    uniform_real_distribution<double> speed(20, 100);
+    discrete_distribution<int> kind(conf.mix, conf.mix + 3);
+
+    World world(side, side);
+    world.set_sensing(conf.sensing);
+    world.set_robot_sensing(conf.robot_sensing);
+    for (size_t i = 0; i < obstacles; ++i) {
+        ObstacleState obst;
+        obst.hitbox = {
+            obst_pos(rng), obst_pos(rng), obst_size(rng), obst_size(rng)
+        };
+        world.add_obstacle(obst);
+    }
+
+    for (size_t i = 0; i < robots; ++i) {
+        Vec2 pos{ robot_pos(rng), robot_pos(rng) };
+        auto a = angle(rng);
+        auto s = speed(rng);
+        switch (kind(rng)) {
+            case 0:
+                world.add_robot(RobotState::dummy(pos, a, s));
+                break;
+            case 1:
+                world.add_robot(RobotState::automatic(pos, a, s));
+                break;
+            default:
+                world.add_robot(RobotState::controlled(pos, a, s));
+                break;
+        }
+    }
+
+    return world;
+}
+
+/**
+ * @brief Measures the simulation of single room and prints the CSV row. It
+ * is run in its own process so that the peak memory of the process is the
+ * peak memory of the room.
+ */
+static void measure(const Config &conf, size_t robots, size_t obstacles) {
+    auto world = generate(conf, robots, obstacles);
+
+    // the first tick builds the acceleration structures
+    world.tick(TICK_DELTA);
+
+    auto start = chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < conf.ticks; ++i) {
+        world.tick(TICK_DELTA);
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    auto secs = elapsed.count();
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    size_t kinds[3]{};
+    for (auto k : world.robots().kind) {
+        ++kinds[static_cast<size_t>(k)];
+    }
+
+    cout << robots << ',' << obstacles << ','
+        << kinds[0] << ',' << kinds[1] << ',' << kinds[2] << ','
+        << world.width() << ',' << conf.ticks << ',' << secs << ','
+        << conf.ticks / secs << ','
+        << (robots ? secs * 1e9 / (conf.ticks * robots) : 0.) << ','
+        // kilobytes on Linux
+        << usage.ru_maxrss << endl;
+}
+
+/**
+ * @brief Parses comma separated list of numbers.
+ */
+static vector<size_t> parse_list(const string &str) {
+    vector<size_t> res;
+    istringstream in(str);
+    string item;
+    while (getline(in, item, ',')) {
+        res.push_back(stoull(item));
+    }
+    if (res.empty()) {
+        throw runtime_error("Empty list " + str);
+    }
+    return res;
+}
+
+/**
+ * @brief Parses the mix of the robots in the form `dummy:auto:control`.
+ */
+static void parse_mix(const string &str, double (&mix)[3]) {
+    istringstream in(str);
+    string item;
+    size_t i = 0;
+    while (getline(in, item, ':')) {
+        if (i >= 3) {
+            throw runtime_error("Too many values in mix " + str);
+        }
+        mix[i++] = stod(item);
+    }
+    if (i != 3 || mix[0] + mix[1] + mix[2] <= 0) {
+        throw runtime_error("Invalid mix " + str);
+    }
+}
+
+/**
+ * @brief Parses the name of the sensing algorithm.
+ * @throws std::runtime_error when the name is unknown.
+ */
+static Sensing parse_sensing(const string &name) {
+    if (name == "tree") {
+        return Sensing::Tree;
+    }
+    if (name == "grid") {
+        return Sensing::Grid;
+    }
+    if (name == "field") {
+        return Sensing::DistanceField;
+    }
+    throw runtime_error("Unknown sensing " + name);
+}
+
+/**
+ * @brief Prints the usage of the program.
+ * @param name Name of the program.
+ */
+static void print_help(const char *name) {
+    cerr << "Usage:" << endl
+        << "  " << name << " [options]" << endl
+        << endl
+        << "Generates rooms with all the combinations of the numbers of"
+        << " robots and" << endl
+        << "obstacles, simulates each of them and prints CSV with the speed"
+        << " of the" << endl
+        << "simulation and peak memory (in kB) to stdout." << endl
+        << endl
+        << "Options:" << endl
+        << "  -r <n,...>   Numbers of robots (default: "
+        << "10,100,1000,10000,100000)." << endl
+        << "  -o <n,...>   Numbers of obstacles (default: "
+        << "10,100,1000,10000,50000)." << endl
+        << "  -m <d:a:c>   Relative amounts of Dummy, Auto and Control robots"
+        << " (default: 1:1:1)." << endl
+        << "  -f <fill>    Part of the room covered by robots and obstacles"
+        << " (default: 0.1)." << endl
+        << "  -n <ticks>   Number of measured ticks (default: 100)." << endl
+        << "  -s <seed>    Seed of the generated rooms (default: 42)."
+        << endl
+        << "  -S <sensing> How the robots find the closest obstacle: tree"
+        << " (default)," << endl
+        << "               grid (uniform grid of the obstacles) or field"
+        << endl
+        << "               (precomputed distances to the obstacles)." << endl
+        << "  -I           The robots don't see the other robots, only the"
+        << " obstacles." << endl;
+}
+
+int main(int argc, char **argv) {
+    Config conf;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            auto arg = argv[i];
+            if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+                print_help(argv[0]);
+                return 0;
+            }
+
+            if (strcmp(arg, "-I") == 0) {
+                conf.robot_sensing = false;
+                continue;
+            }
+
+            if (i + 1 >= argc) {
+                throw runtime_error(string("Missing value for ") + arg);
+            }
+
+            if (strcmp(arg, "-r") == 0) {
+                conf.robots = parse_list(argv[++i]);
+            } else if (strcmp(arg, "-o") == 0) {
+                conf.obstacles = parse_list(argv[++i]);
+            } else if (strcmp(arg, "-m") == 0) {
+                parse_mix(argv[++i], conf.mix);
+            } else if (strcmp(arg, "-f") == 0) {
+                conf.fill = stod(argv[++i]);
+            } else if (strcmp(arg, "-n") == 0) {
+                conf.ticks = stoull(argv[++i]);
+            } else if (strcmp(arg, "-s") == 0) {
+                conf.seed = stoul(argv[++i]);
+            } else if (strcmp(arg, "-S") == 0) {
+                conf.sensing = parse_sensing(argv[++i]);
+            } else {
+                throw runtime_error(string("Unknown option ") + arg);
+            }
+        }
+        if (conf.fill <= 0 || conf.ticks == 0) {
+            throw runtime_error("Fill and ticks must be positive");
+        }
+    } catch (const exception &e) {
+        cerr << "Invalid arguments: " << e.what() << endl;
+        print_help(argv[0]);
+        return 1;
+    }
+
+    cout << "robots,obstacles,dummy,auto,control,room_size,ticks,seconds,"
+        << "ticks_per_s,ns_per_robot_tick,peak_rss_kb" << endl;
+
+    for (auto robots : conf.robots) {
+        for (auto obstacles : conf.obstacles) {
+            cerr << robots << " robots, " << obstacles << " obstacles"
+                << endl;
+
+            auto pid = fork();
+            if (pid < 0) {
+                cerr << "Failed to start measurement: " << strerror(errno)
+                    << endl;
+                return 1;
+            }
+            if (pid == 0) {
+                measure(conf, robots, obstacles);
+                _exit(0);
+            }
+
+            int status;
+            waitpid(pid, &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                cerr << "Measurement failed" << endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,361 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Entry point of the command line simulation without any window.
+ */
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "binary_room.hpp"
+#include "input_log.hpp"
+#include "loader.hpp"
+#include "mapped_file.hpp"
+#include "state_file.hpp"
+#include "trajectory.hpp"
+#include "world.hpp"
+
+using namespace std;
+using namespace icp;
+
+/**
+ * @brief Prints the usage of the program.
+ * @param name Name of the program.
+ */
+static void print_help(const char *name) {
+    cerr << "Usage:" << endl
+        << "  " << name << " <room-file> [options]" << endl
+        << "  " << name << " -i <input-log> [options]" << endl
+        << endl
+        << "Loads the room, simulates it and writes the final state in the"
+        << " format of the room" << endl
+        << "file. The number of ticks per second is printed to stderr."
+        << endl
+        << endl
+        << "Options:" << endl
+        << "  -n <ticks>   Number of ticks to simulate (default: 1000)."
+        << endl
+        << "  -d <delta>   Duration of single tick in seconds (default: "
+        << TICK_DELTA << ")." << endl
+        << "  -o <file>    Write the final state to the file instead of stdout"
+        << " (in the" << endl
+        << "               binary format if it ends with " << BINARY_ROOM_EXT
+        << ", as complete" << endl
+        << "               state that can be resumed if it ends with "
+        << STATE_FILE_EXT << ")." << endl
+        << "  -r <file>    Record the trajectories of the robots in all the"
+        << " ticks to the file" << endl
+        << "               that can be replayed in the window." << endl
+        << "  -D           Deterministic mode, the result is bit-identical when"
+        << " repeated." << endl
+        << "  -i <file>    Apply the changes from the input log written by"
+        << " the window" << endl
+        << "               (--input-log) at their ticks, the simulation starts"
+        << " from the state" << endl
+        << "               at the start of the log and the given number of"
+        << " ticks is" << endl
+        << "               simulated after the last input. Implies -D." << endl
+        << "  -H           Print hash of the final state to compare results of"
+        << " simulations." << endl
+        << "  -b           Check collisions of all pairs of robots instead of"
+        << " using grid." << endl
+        << "  -s <sensing> How the robots find the closest obstacle: tree"
+        << " (default)," << endl
+        << "               grid (uniform grid of the obstacles) or field"
+        << endl
+        << "               (precomputed distances to the obstacles)." << endl
+        << "  -I           The robots don't see the other robots, only the"
+        << " obstacles." << endl
+        << "  -p           Print durations of the phases of the last "
+        << Profiler::WINDOW << " ticks." << endl;
+}
+
+/**
+ * @brief Prints the statistics of the phases of the ticks in microseconds.
+ * @param profiler Profiler with the durations of the phases.
+ */
+static void print_profile(const Profiler &profiler) {
+    cerr << left << setw(10) << "phase" << right
+        << setw(10) << "min [us]" << setw(10) << "avg [us]"
+        << setw(10) << "p99 [us]" << endl;
+    cerr << fixed << setprecision(1);
+    for (auto phase : { Phase::Move, Phase::Border, Phase::Obstacles,
+                        Phase::Robots }) {
+        auto s = profiler.stats(phase);
+        cerr << left << setw(10) << phase_name(phase) << right
+            << setw(10) << s.min * 1e6 << setw(10) << s.avg * 1e6
+            << setw(10) << s.p99 * 1e6 << endl;
+    }
+}
+
+/**
+ * @brief Checks whether the input can be applied to the world (the index is
+ * valid and the world is at the tick of the input).
+ */
+static bool valid_input(const Input &input, const World &world) {
+    if (input.tick != world.ticks()) {
+        return false;
+    }
+    // every kind is listed so that a new kind isn't accepted unchecked
+    switch (input.kind) {
+        case InputKind::SetSize:
+        case InputKind::AddRobot:
+        case InputKind::AddObstacle:
+        case InputKind::Restore:
+            return true;
+        case InputKind::RemoveRobot:
+        case InputKind::SetRobot:
+        case InputKind::MoveRobot:
+        case InputKind::SetRobotSpeed:
+        case InputKind::SetRobotAngle:
+        case InputKind::GrabRobot:
+        case InputKind::SetRobotParams:
+            return input.idx < world.robots().size();
+        case InputKind::RemoveObstacle:
+        case InputKind::SetObstacle:
+            return input.idx < world.obstacles().size();
+    }
+    return false;
+}
+
+/**
+ * @brief Parses the name of the sensing algorithm.
+ * @throws std::runtime_error when the name is unknown.
+ */
+static Sensing parse_sensing(const string &name) {
+    if (name == "tree") {
+        return Sensing::Tree;
+    }
+    if (name == "grid") {
+        return Sensing::Grid;
+    }
+    if (name == "field") {
+        return Sensing::DistanceField;
+    }
+    throw runtime_error("Unknown sensing " + name);
+}
+
+int main(int argc, char **argv) {
+    string input;
+    string output;
+    string record;
+    string input_log;
+    unsigned long long ticks = 1000;
+    double delta = TICK_DELTA;
+    auto broadphase = Broadphase::Grid;
+    auto sensing = Sensing::Tree;
+    auto profile = false;
+    auto deterministic = false;
+    auto hash = false;
+    auto robot_sensing = true;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            auto arg = argv[i];
+            if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+                print_help(argv[0]);
+                return 0;
+            }
+
+            if (arg[0] != '-') {
+                input = arg;
+                continue;
+            }
+
+            if (strcmp(arg, "-b") == 0) {
+                broadphase = Broadphase::BruteForce;
+                continue;
+            }
+
+            if (strcmp(arg, "-p") == 0) {
+                profile = true;
+                continue;
+            }
+
+            if (strcmp(arg, "-D") == 0) {
+                deterministic = true;
+                continue;
+            }
+
+            if (strcmp(arg, "-H") == 0) {
+                hash = true;
+                continue;
+            }
+
+            if (strcmp(arg, "-I") == 0) {
+                robot_sensing = false;
+                continue;
+            }
+
+            if (i + 1 >= argc) {
+                throw runtime_error(string("Missing value for ") + arg);
+            }
+
+            if (strcmp(arg, "-n") == 0) {
+                ticks = stoull(argv[++i]);
+            } else if (strcmp(arg, "-d") == 0) {
+                delta = stod(argv[++i]);
+            } else if (strcmp(arg, "-o") == 0) {
+                output = argv[++i];
+            } else if (strcmp(arg, "-r") == 0) {
+                record = argv[++i];
+            } else if (strcmp(arg, "-s") == 0) {
+                sensing = parse_sensing(argv[++i]);
+            } else if (strcmp(arg, "-i") == 0) {
+                input_log = argv[++i];
+                deterministic = true;
+            } else {
+                throw runtime_error(string("Unknown option ") + arg);
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Invalid arguments: " << e.what() << endl;
+        print_help(argv[0]);
+        return 1;
+    }
+
+    if (input.empty() && input_log.empty()) {
+        print_help(argv[0]);
+        return 1;
+    }
+
+    World world;
+    try {
+        if (!input.empty()) {
+            world = Loader(input).load();
+        }
+    } catch (const exception &e) {
+        cerr << "Error loading room: " << e.what() << endl;
+        return 1;
+    }
+    world.set_broadphase(broadphase);
+    world.set_sensing(sensing);
+    world.set_robot_sensing(robot_sensing);
+    world.set_deterministic(deterministic);
+
+    vector<Input> inputs;
+    try {
+        if (!input_log.empty()) {
+            MappedFile file(input_log);
+            inputs = load_input_log(file.data(), file.size());
+        }
+    } catch (const exception &e) {
+        cerr << "Error loading input log: " << e.what() << endl;
+        return 1;
+    }
+
+    // the log starts with the state of the world when it was started
+    size_t next = 0;
+    if (!inputs.empty() && inputs[0].kind == InputKind::Restore) {
+        inputs[0].apply(world);
+        next = 1;
+    }
+
+    unique_ptr<TrajectoryWriter> recorder;
+    try {
+        if (!record.empty()) {
+            recorder = make_unique<TrajectoryWriter>(record);
+            recorder->record(world, true);
+        }
+    } catch (const exception &e) {
+        cerr << "Error recording trajectories: " << e.what() << endl;
+        return 1;
+    }
+
+    // applies the inputs that were applied before the current tick
+    auto apply_inputs = [&] {
+        for (; next < inputs.size(); ++next) {
+            auto &in = inputs[next];
+            if (in.tick > world.ticks()) {
+                return;
+            }
+            if (!valid_input(in, world)) {
+                throw runtime_error(
+                    "The input log doesn't match the room at tick "
+                    + to_string(in.tick)
+                );
+            }
+            in.apply(world);
+            if (recorder) {
+                recorder->record(world, true);
+            }
+        }
+    };
+
+    unsigned long long done = 0;
+    auto tick = [&] {
+        world.tick(delta);
+        if (recorder) {
+            recorder->record(world);
+        }
+        ++done;
+    };
+
+    auto start = chrono::steady_clock::now();
+    try {
+        // `ticks` are counted from the last input
+        apply_inputs();
+        while (next < inputs.size()) {
+            tick();
+            apply_inputs();
+        }
+        for (unsigned long long i = 0; i < ticks; ++i) {
+            tick();
+        }
+    } catch (const exception &e) {
+        cerr << "Error applying input log: " << e.what() << endl;
+        return 1;
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    if (recorder) {
+        try {
+            recorder->finish();
+        } catch (const exception &e) {
+            cerr << "Error recording trajectories: " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    if (output.empty()) {
+        world.save(cout);
+    } else {
+        auto state = has_state_file_ext(output);
+        auto binary = state || has_binary_room_ext(output);
+        ofstream file(output, binary ? ios::binary : ios::out);
+        if (!file.is_open()) {
+            cerr << "Error saving room: File cannot be accessed" << endl;
+            return 1;
+        }
+        if (state) {
+            save_state_file(world.state(), file);
+        } else if (binary) {
+            save_binary_room(world, file);
+        } else {
+            world.save(file);
+        }
+    }
+
+    cerr << done << " ticks in " << elapsed.count() << " s";
+    if (done > 0 && elapsed.count() > 0) {
+        cerr << " (" << done / elapsed.count() << " ticks/s)";
+    }
+    cerr << endl;
+
+    if (profile) {
+        print_profile(world.profiler());
+    }
+
+    if (hash) {
+        cerr << "state hash: " << hex << setw(16) << setfill('0')
+            << state_hash(world.state()) << endl;
+    }
+}
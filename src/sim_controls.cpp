@@ -6,15 +6,26 @@
 
 #include "sim_controls.hpp"
 
+#include <cmath>
+
+#include "world.hpp"
+
 namespace icp {
 
+/**
+ * @brief Simulation speeds that can be selected.
+ */
+constexpr double TIME_SCALES[] = { 1, 2, 5, 10, 100, INFINITY };
+
 //---------------------------------------------------------------------------//
 //                                  PUBLIC                                   //
 //---------------------------------------------------------------------------//
 
 SimControls::SimControls(QRect rect, QWidget *parent)
     : QWidget(parent),
-    is_playing(true)
+    is_playing(true),
+    history_first(0),
+    history_last(0)
 {
     layout = new QHBoxLayout(this);
 
@@ -26,6 +37,54 @@ SimControls::SimControls(QRect rect, QWidget *parent)
     load = new QPushButton("load", this);
     connect(load, &QPushButton::clicked, this, &SimControls::handle_load);
 
+    // records the trajectories to the file in the path input
+    record = new QPushButton("rec", this);
+    record->setCheckable(true);
+    connect(
+        record,
+        &QPushButton::toggled,
+        this,
+        &SimControls::handle_record
+    );
+
+    progress = new QProgressBar(this);
+    progress->setRange(0, 100);
+    progress->setMaximumWidth(100);
+    progress->hide();
+
+    speed = new QComboBox(this);
+    for (auto s : TIME_SCALES) {
+        speed->addItem(std::isinf(s) ? "max" : QString("×%1").arg(s));
+    }
+    connect(
+        speed,
+        QOverload<int>::of(&QComboBox::currentIndexChanged),
+        this,
+        &SimControls::handle_time_scale
+    );
+
+    rate = new QLabel(this);
+    rate->setMinimumWidth(60);
+
+    // scrubs the history while paused
+    history = new QSlider(Qt::Horizontal, this);
+    history->setRange(0, 0);
+    history->setEnabled(false);
+    history->setToolTip("rewind");
+    connect(
+        history,
+        &QSlider::valueChanged,
+        this,
+        &SimControls::handle_seek
+    );
+
+    history_time = new QLabel(this);
+    history_time->setMinimumWidth(60);
+
+    stats = new QPushButton("stats", this);
+    stats->setCheckable(true);
+    connect(stats, &QPushButton::toggled, this, &SimControls::show_profile);
+
     play_pause = new QPushButton("pause", this);
     connect(
         play_pause,
@@ -37,6 +96,13 @@ SimControls::SimControls(QRect rect, QWidget *parent)
     layout->addWidget(path_input, 1);
     layout->addWidget(save);
     layout->addWidget(load);
+    layout->addWidget(record);
+    layout->addWidget(progress);
+    layout->addWidget(history, 1);
+    layout->addWidget(history_time);
+    layout->addWidget(speed);
+    layout->addWidget(rate);
+    layout->addWidget(stats);
     layout->addWidget(play_pause);
 
     relayout(rect);
@@ -50,6 +116,50 @@ bool SimControls::playing() {
     return is_playing;
 }
 
+double SimControls::time_scale() {
+    return TIME_SCALES[speed->currentIndex()];
+}
+
+//---------------------------------------------------------------------------//
+//                               PUBLIC SLOTS                                //
+//---------------------------------------------------------------------------//
+
+void SimControls::show_rate(double rate) {
+    this->rate->setText(QString("×%1").arg(rate, 0, 'f', 1));
+}
+
+void SimControls::show_history(
+    std::uint64_t first,
+    std::uint64_t last,
+    std::uint64_t tick
+) {
+    history_first = first;
+    history_last = last;
+
+    QSignalBlocker block(history);
+    history->setRange(0, last - first);
+    history->setValue(tick - first);
+    history_time->setText(
+        QString("%1 s").arg(-double(last - tick) * TICK_DELTA, 0, 'f', 2)
+    );
+}
+
+void SimControls::set_busy(bool busy) {
+    save->setEnabled(!busy);
+    load->setEnabled(!busy);
+    progress->setValue(0);
+    progress->setVisible(busy);
+}
+
+void SimControls::show_progress(int percent) {
+    progress->setValue(percent);
+}
+
+void SimControls::set_recording(bool recording) {
+    QSignalBlocker block(record);
+    record->setChecked(recording);
+}
+
 //---------------------------------------------------------------------------//
 //                              PRIVATE SLOTS                                //
 //---------------------------------------------------------------------------//
@@ -57,9 +167,24 @@ bool SimControls::playing() {
 void SimControls::handle_play_pause(bool checked) {
     is_playing = !is_playing;
     play_pause->setText(is_playing ? "pause" : "play");
+    history->setEnabled(!is_playing);
     emit run_simulation(is_playing);
 }
 
+void SimControls::handle_time_scale(int index) {
+    emit change_time_scale(TIME_SCALES[index]);
+}
+
+void SimControls::handle_seek(int value) {
+    history_time->setText(QString("%1 s").arg(
+        -double(history_last - history_first - value) * TICK_DELTA,
+        0,
+        'f',
+        2
+    ));
+    emit seek(history_first + value);
+}
+
 void SimControls::handle_save() {
     emit save_room(path_input->text().toStdString());
 }
@@ -68,5 +193,13 @@ void SimControls::handle_load() {
     emit load_room(path_input->text().toStdString());
 }
 
+void SimControls::handle_record(bool checked) {
+    if (checked) {
+        emit start_recording(path_input->text().toStdString());
+    } else {
+        emit stop_recording();
+    }
+}
+
 } // namespace icp
 
@@ -11,6 +11,12 @@
 #include <QPointer>
 #include <QLineEdit>
 #include <QHBoxLayout>
+#include <QComboBox>
+#include <QLabel>
+#include <QProgressBar>
+#include <QSlider>
+
+#include <cstdint>
 
 namespace icp {
 
@@ -39,6 +45,52 @@ public:
      */
     bool playing();
 
+    /**
+     * @brief Returns the selected number of simulated seconds per real
+     * second (`INFINITY` for maximum speed).
+     */
+    double time_scale();
+
+public slots:
+    /**
+     * @brief Shows the achieved simulation speed.
+     * @param rate Simulated seconds per real second.
+     */
+    void show_rate(double rate);
+
+    /**
+     * @brief Shows or hides the progress of loading/saving. Loading and
+     * saving is disabled while busy.
+     * @param busy `true` when room is being loaded or saved.
+     */
+    void set_busy(bool busy);
+
+    /**
+     * @brief Shows the progress of loading/saving.
+     * @param percent Done part of the work in percents.
+     */
+    void show_progress(int percent);
+
+    /**
+     * @brief Shows whether the trajectories are recorded (without emitting
+     * any signal).
+     * @param recording `true` if the trajectories are recorded.
+     */
+    void set_recording(bool recording);
+
+    /**
+     * @brief Shows the range of the history to which the simulation can be
+     * rewound. The history can be scrubbed only while paused.
+     * @param first The oldest tick in the history.
+     * @param last The newest tick in the history.
+     * @param tick The tick at which are the shown robots.
+     */
+    void show_history(
+        std::uint64_t first,
+        std::uint64_t last,
+        std::uint64_t tick
+    );
+
 signals:
     /**
      * @brief Play/Pause button was pressed.
@@ -46,6 +98,26 @@ signals:
      */
     void run_simulation(bool play);
 
+    /**
+     * @brief Different simulation speed was selected.
+     * @param scale Simulated seconds per real second (`INFINITY` for
+     * maximum speed).
+     */
+    void change_time_scale(double scale);
+
+    /**
+     * @brief Stats button was toggled.
+     * @param show `true` if the durations of the phases of the simulation
+     * should be shown, otherwise `false`.
+     */
+    void show_profile(bool show);
+
+    /**
+     * @brief Tick in the history was selected.
+     * @param tick The tick at which the robots should be shown.
+     */
+    void seek(std::uint64_t tick);
+
     /**
      * @brief Save button was pressed
      * @param filename file to save room into
@@ -58,20 +130,44 @@ signals:
      */
     void load_room(std::string filename);
 
+    /**
+     * @brief Record button was checked.
+     * @param filename file to record the trajectories into
+     */
+    void start_recording(std::string filename);
+
+    /**
+     * @brief Record button was unchecked.
+     */
+    void stop_recording();
+
 private slots:
     void handle_play_pause(bool checked);
+    void handle_time_scale(int index);
+    void handle_seek(int value);
 
     void handle_save();
     void handle_load();
+    void handle_record(bool checked);
 
 private:
     QPointer<QHBoxLayout> layout;
     QPointer<QLineEdit> path_input;
     QPointer<QPushButton> play_pause;
+    QPointer<QComboBox> speed;
+    QPointer<QLabel> rate;
+    QPointer<QSlider> history;
+    QPointer<QLabel> history_time;
+    QPointer<QPushButton> stats;
     QPointer<QPushButton> save;
     QPointer<QPushButton> load;
+    QPointer<QPushButton> record;
+    QPointer<QProgressBar> progress;
 
     bool is_playing;
+    // tick at the start of the history slider
+    std::uint64_t history_first;
+    std::uint64_t history_last;
 };
 
 } // namespace icp
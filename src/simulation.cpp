@@ -0,0 +1,418 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Runs the world on its own thread. (source file)
+ */
+
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <future>
+#include <utility>
+
+namespace icp {
+
+using namespace std;
+
+//---------------------------------------------------------------------------//
+//                               WorldSnapshot                               //
+//---------------------------------------------------------------------------//
+
+Vec2 WorldSnapshot::position(size_t idx, chrono::steady_clock::time_point t)
+    const
+{
+    chrono::duration<double> since = t - time;
+    auto a = clamp(since.count() / TICK_DELTA, 0., 1.);
+    auto x = prev_x[idx] + (robots.x[idx] - prev_x[idx]) * a;
+    auto y = prev_y[idx] + (robots.y[idx] - prev_y[idx]) * a;
+    return { x, y };
+}
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+Simulation::Simulation(World world) :
+    world(std::move(world)),
+    running(true),
+    scale(1),
+    accumulator(0),
+    ticks(0),
+    applied(0),
+    prev_x(this->world.robots().x),
+    prev_y(this->world.robots().y),
+    history(),
+    seeking(false),
+    seek_tick(0),
+    seek_x(),
+    seek_y(),
+    seek_angle(),
+    recorder(),
+    input_log(),
+    rate_start(chrono::steady_clock::now()),
+    rate_ticks(0),
+    rate(0),
+    mrunning(true),
+    mtime_scale(1),
+    mrecording(false),
+    mdeterministic(this->world.deterministic()),
+    sent(0),
+    mtx(),
+    cv(),
+    commands(),
+    stop(false),
+    snapshots(),
+    worker(&Simulation::run, this)
+{}
+
+Simulation::~Simulation() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_one();
+    worker.join();
+}
+
+void Simulation::set_running(bool running) {
+    mrunning = running;
+    push([this, running](World &) {
+        // measure the rate only while running
+        rate_start = chrono::steady_clock::now();
+        rate_ticks = ticks;
+        rate = 0;
+        this->running = running;
+    });
+}
+
+void Simulation::set_time_scale(double scale) {
+    mtime_scale = scale;
+    push([this, scale](World &) {
+        // time accumulated with the old scale doesn't apply to the new one
+        this->scale = scale;
+        accumulator = 0;
+    });
+}
+
+void Simulation::push(Command cmd) {
+    {
+        lock_guard<mutex> lock(mtx);
+        commands.push_back(std::move(cmd));
+    }
+    ++sent;
+    cv.notify_one();
+}
+
+void Simulation::call(Command cmd) {
+    promise<void> done;
+    auto res = done.get_future();
+    push([&](World &w) {
+        try {
+            cmd(w);
+            done.set_value();
+        } catch (...) {
+            done.set_exception(current_exception());
+        }
+    });
+    res.get();
+}
+
+void Simulation::apply(Input input) {
+    push([this, input](World &w) mutable {
+        input.tick = w.ticks();
+        input.apply(w);
+        if (input_log) {
+            input_log->write(input);
+        }
+    });
+}
+
+void Simulation::restore(const WorldState &state) {
+    apply(Input::restore(make_shared<const WorldState>(state)));
+}
+
+void Simulation::set_deterministic(bool deterministic) {
+    mdeterministic = deterministic;
+    push([=](World &w) { w.set_deterministic(deterministic); });
+}
+
+void Simulation::set_sensing(Sensing sensing) {
+    push([=](World &w) { w.set_sensing(sensing); });
+}
+
+void Simulation::set_robot_sensing(bool sensing) {
+    push([=](World &w) { w.set_robot_sensing(sensing); });
+}
+
+void Simulation::set_input_log(shared_ptr<InputLogWriter> log) {
+    push([this, log](World &w) {
+        input_log = log;
+        if (input_log) {
+            auto input = Input::restore(make_shared<const WorldState>(
+                w.state()
+            ));
+            input.tick = w.ticks();
+            input_log->write(input);
+        }
+    });
+}
+
+void Simulation::set_rewind_budget(size_t bytes) {
+    push([this, bytes](World &) { history.set_budget(bytes); });
+}
+
+void Simulation::seek(uint64_t tick) {
+    push([this, tick](World &w) {
+        // history with different robots cannot be shown
+        seeking = history.positions(tick, seek_x, seek_y, seek_angle)
+            && seek_x.size() == w.robots().size();
+        seek_tick = tick;
+    });
+}
+
+shared_ptr<const WorldState> Simulation::rewind() {
+    shared_ptr<const WorldState> res;
+    call([&](World &w) {
+        auto tick = w.ticks();
+        auto key = seeking ? history.keyframe(seek_tick) : nullptr;
+        seeking = false;
+        if (!key) {
+            return;
+        }
+
+        // the world is changed only by ticks within a segment of the
+        // history, so the same ticks lead to the same state
+        w.restore(*key);
+        while (w.ticks() < seek_tick) {
+            w.tick(TICK_DELTA);
+        }
+        history.truncate(seek_tick);
+        res = make_shared<const WorldState>(w.state());
+        if (input_log) {
+            // the log continues from the rewound state
+            auto input = Input::restore(res);
+            input.tick = tick;
+            input_log->write(input);
+        }
+    });
+    return res;
+}
+
+void Simulation::start_recording(const string &filename) {
+    stop_recording();
+    call([&](World &w) {
+        recorder = make_unique<TrajectoryWriter>(filename);
+        recorder->record(w, true);
+    });
+    mrecording = true;
+}
+
+void Simulation::stop_recording() {
+    if (!mrecording) {
+        return;
+    }
+    mrecording = false;
+    call([this](World &) {
+        auto rec = std::move(recorder);
+        rec->finish();
+    });
+}
+
+void Simulation::set_size(double width, double height) {
+    apply(Input::set_size(width, height));
+}
+
+void Simulation::add_robot(const RobotState &robot) {
+    apply(Input::add_robot(robot));
+}
+
+void Simulation::add_obstacle(const ObstacleState &obstacle) {
+    apply(Input::add_obstacle(obstacle));
+}
+
+void Simulation::remove_robot(size_t idx) {
+    apply(Input::remove_robot(idx));
+}
+
+void Simulation::remove_obstacle(size_t idx) {
+    apply(Input::remove_obstacle(idx));
+}
+
+void Simulation::set_robot(size_t idx, const RobotState &robot) {
+    apply(Input::set_robot(idx, robot));
+}
+
+void Simulation::move_robot(size_t idx, Vec2 position) {
+    apply(Input::move_robot(idx, position));
+}
+
+void Simulation::set_robot_speed(size_t idx, double speed) {
+    apply(Input::set_robot_speed(idx, speed));
+}
+
+void Simulation::set_robot_angle(size_t idx, double angle) {
+    apply(Input::set_robot_angle(idx, angle));
+}
+
+void Simulation::set_robot_grabbed(size_t idx, bool grabbed) {
+    apply(Input::set_robot_grabbed(idx, grabbed));
+}
+
+void Simulation::set_robot_params(size_t idx, const RobotState &robot) {
+    apply(Input::set_robot_params(idx, robot));
+}
+
+void Simulation::set_obstacle(size_t idx, const ObstacleState &obstacle) {
+    apply(Input::set_obstacle(idx, obstacle));
+}
+
+const WorldSnapshot *Simulation::poll() {
+    snapshots.update();
+
+    // Older snapshot may have robots at different indexes than the view
+    // already has.
+    auto &snap = snapshots.front();
+    return snap.commands == sent ? &snap : nullptr;
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+void Simulation::run() {
+    using dsec = chrono::duration<double>;
+
+    auto wake = [&] { return stop || !commands.empty(); };
+    auto last = chrono::steady_clock::now();
+    history.record(world, true);
+
+    unique_lock<mutex> lock(mtx);
+    while (!stop) {
+        auto cmds = std::move(commands);
+        commands.clear();
+        lock.unlock();
+
+        // the time since the last step passed with the old `running` and
+        // `scale`, infinite scale doesn't accumulate time and just ticks
+        // until `MAX_CATCH_UP`
+        auto now = chrono::steady_clock::now();
+        auto unbounded = isinf(scale);
+        if (running && !unbounded) {
+            accumulator = min(
+                accumulator + dsec(now - last).count() * scale,
+                dsec(MAX_CATCH_UP).count() * scale
+            );
+        }
+        last = now;
+
+        for (auto &cmd : cmds) {
+            cmd(world);
+        }
+        applied += cmds.size();
+        // the commands may have changed the scale
+        unbounded = isinf(scale);
+        if (!cmds.empty()) {
+            // the robots may have been moved or removed, don't interpolate
+            save_positions();
+            history.record(world, true);
+            if (recorder) {
+                recorder->record(world, true);
+            }
+        }
+
+        auto tick = false;
+        while (running && (unbounded || accumulator >= TICK_DELTA)) {
+            save_positions();
+            world.tick(TICK_DELTA);
+            history.record(world);
+            if (recorder) {
+                recorder->record(world);
+            }
+            seeking = false;
+            ++ticks;
+            if (!unbounded) {
+                accumulator -= TICK_DELTA;
+            }
+            tick = true;
+
+            // let the commands in and publish the state from time to time
+            if (chrono::steady_clock::now() - now >= MAX_CATCH_UP) {
+                break;
+            }
+        }
+
+        measure_rate(now);
+        if (tick || !cmds.empty()) {
+            auto behind = unbounded ? 0 : accumulator / scale;
+            publish(
+                now - chrono::duration_cast<chrono::steady_clock::duration>(
+                    dsec(behind)
+                )
+            );
+        }
+
+        lock.lock();
+        if (!running) {
+            cv.wait(lock, wake);
+        } else if (!unbounded && accumulator < TICK_DELTA) {
+            // with different time scale, tick in batches once per tick
+            // length so that snapshots aren't published too often
+            auto wait = scale == 1
+                ? TICK_DELTA - accumulator
+                : max((TICK_DELTA - accumulator) / scale, TICK_DELTA);
+            cv.wait_until(
+                lock,
+                now + chrono::duration_cast<chrono::steady_clock::duration>(
+                    dsec(wait)
+                ),
+                wake
+            );
+        }
+    }
+}
+
+void Simulation::save_positions() {
+    prev_x = world.robots().x;
+    prev_y = world.robots().y;
+}
+
+void Simulation::publish(chrono::steady_clock::time_point time) {
+    auto &snap = snapshots.back();
+    snap.robots = world.robots();
+    if (seeking) {
+        snap.robots.x = seek_x;
+        snap.robots.y = seek_y;
+        snap.robots.angle = seek_angle;
+        snap.robots.update_directions();
+        snap.prev_x = seek_x;
+        snap.prev_y = seek_y;
+    } else {
+        snap.prev_x = prev_x;
+        snap.prev_y = prev_y;
+    }
+    snap.time = time;
+    snap.ticks = ticks;
+    snap.commands = applied;
+    snap.rate = rate;
+    snap.profile = world.profiler().profile();
+    snap.tick = seeking ? seek_tick : world.ticks();
+    snap.history_first = history.first();
+    snap.history_last = history.last();
+    snap.seeking = seeking;
+    snapshots.publish();
+}
+
+void Simulation::measure_rate(chrono::steady_clock::time_point now) {
+    chrono::duration<double> elapsed = now - rate_start;
+    if (elapsed < RATE_PERIOD) {
+        return;
+    }
+
+    rate = (ticks - rate_ticks) * TICK_DELTA / elapsed.count();
+    rate_start = now;
+    rate_ticks = ticks;
+}
+
+} // namespace icp
@@ -0,0 +1,313 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Runs the world on its own thread. (header file)
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "input_log.hpp"
+#include "rewind.hpp"
+#include "trajectory.hpp"
+#include "triple_buffer.hpp"
+#include "world.hpp"
+
+namespace icp {
+
+/**
+ * @brief Maximum time that is caught up at once when the simulation falls
+ * behind the real time. The rest of the time is dropped. It is also the
+ * longest time for which the simulation ticks without publishing snapshot.
+ */
+constexpr std::chrono::milliseconds MAX_CATCH_UP(100);
+
+/**
+ * @brief How long is the rate of the simulation measured.
+ */
+constexpr std::chrono::milliseconds RATE_PERIOD(500);
+
+/**
+ * @brief State of the world published by the simulation thread.
+ */
+struct WorldSnapshot {
+    /**
+     * @brief Gets the position of the robot at the given time interpolated
+     * between the last two ticks. The shown state is one tick behind the
+     * simulation so that it moves smoothly at any frame rate.
+     * @param idx Index of the robot.
+     * @param t Time at which the robot is shown.
+     * @return Top-left corner of the hitbox of the robot.
+     */
+    Vec2 position(std::size_t idx, std::chrono::steady_clock::time_point t)
+        const;
+
+    /** @brief States of the robots. */
+    RobotArrays robots;
+    /** @brief X positions of the robots before the last tick. */
+    std::vector<double> prev_x;
+    /** @brief Y positions of the robots before the last tick. */
+    std::vector<double> prev_y;
+    /** @brief Time to which the last tick corresponds. */
+    std::chrono::steady_clock::time_point time;
+    /** @brief Number of ticks simulated so far. */
+    std::uint64_t ticks = 0;
+    /** @brief Number of commands applied to the world so far. */
+    std::uint64_t commands = 0;
+    /** @brief Simulated seconds per real second measured recently. */
+    double rate = 0;
+    /** @brief Durations of the phases of the recent ticks. */
+    Profile profile;
+    /**
+     * @brief Tick of the world at which are the robots (the tick selected
+     * by `Simulation::seek` while seeking).
+     */
+    std::uint64_t tick = 0;
+    /** @brief Oldest tick to which the simulation can be rewound. */
+    std::uint64_t history_first = 0;
+    /** @brief Newest tick to which the simulation can be rewound. */
+    std::uint64_t history_last = 0;
+    /** @brief The robots are shown at tick selected by `Simulation::seek`. */
+    bool seeking = false;
+};
+
+/**
+ * @brief Ticks the world on a worker thread in real time with fixed time
+ * step. As many ticks as the elapsed time needs are done (up to
+ * `MAX_CATCH_UP`), so the simulated time doesn't drift. The world is never
+ * accessed directly from other threads: changes are sent as commands and the
+ * state is read from snapshots. All the methods must be called from the
+ * thread that created the simulation.
+ */
+class Simulation {
+public:
+    /**
+     * @brief Command executed on the world by the simulation thread.
+     */
+    using Command = std::function<void(World &)>;
+
+    /**
+     * @brief Starts the simulation thread with running simulation.
+     * @param world The simulated world.
+     */
+    Simulation(World world = World());
+
+    Simulation(const Simulation &) = delete;
+    Simulation &operator=(const Simulation &) = delete;
+
+    /**
+     * @brief Stops the simulation thread.
+     */
+    ~Simulation();
+
+    /**
+     * @brief Checks whether the world is ticking.
+     */
+    bool is_running() const { return mrunning; }
+
+    /**
+     * @brief Starts or pauses ticking of the world.
+     */
+    void set_running(bool running);
+
+    /**
+     * @brief Gets the number of simulated seconds per real second.
+     */
+    double time_scale() const { return mtime_scale; }
+
+    /**
+     * @brief Sets the number of simulated seconds per real second.
+     * `INFINITY` ticks as fast as possible. When it isn't 1, the snapshots
+     * are published at most once per tick length of real time.
+     */
+    void set_time_scale(double scale);
+
+    /**
+     * @brief Sends command to the simulation thread. Commands are executed
+     * in the order in which they were sent, before the next tick.
+     */
+    void push(Command cmd);
+
+    /**
+     * @brief Executes the command on the simulation thread and waits until
+     * it finishes. Exceptions thrown by the command are rethrown.
+     */
+    void call(Command cmd);
+
+    /**
+     * @brief Sends the input to the simulation thread. It is applied before
+     * the next tick and written to the input log (if any).
+     */
+    void apply(Input input);
+
+    /** @brief Sends `World::restore`. */
+    void restore(const WorldState &state);
+    /** @brief Sends `World::set_size`. */
+    void set_size(double width, double height);
+    /** @brief Sends `World::add_robot`. */
+    void add_robot(const RobotState &robot);
+    /** @brief Sends `World::add_obstacle`. */
+    void add_obstacle(const ObstacleState &obstacle);
+    /** @brief Sends `World::remove_robot`. */
+    void remove_robot(std::size_t idx);
+    /** @brief Sends `World::remove_obstacle`. */
+    void remove_obstacle(std::size_t idx);
+    /** @brief Sends `World::set_robot`. */
+    void set_robot(std::size_t idx, const RobotState &robot);
+    /** @brief Sends `World::move_robot`. */
+    void move_robot(std::size_t idx, Vec2 position);
+    /** @brief Sends `World::set_robot_speed`. */
+    void set_robot_speed(std::size_t idx, double speed);
+    /** @brief Sends `World::set_robot_angle`. */
+    void set_robot_angle(std::size_t idx, double angle);
+    /** @brief Sends `World::set_robot_grabbed`. */
+    void set_robot_grabbed(std::size_t idx, bool grabbed);
+    /** @brief Sends `World::set_robot_params`. */
+    void set_robot_params(std::size_t idx, const RobotState &robot);
+    /** @brief Sends `World::set_obstacle`. */
+    void set_obstacle(std::size_t idx, const ObstacleState &obstacle);
+
+    /**
+     * @brief Checks whether the world is in deterministic mode.
+     */
+    bool is_deterministic() const { return mdeterministic; }
+
+    /**
+     * @brief Sends `World::set_deterministic`.
+     */
+    void set_deterministic(bool deterministic);
+
+    /**
+     * @brief Sends `World::set_sensing`.
+     */
+    void set_sensing(Sensing sensing);
+
+    /**
+     * @brief Sends `World::set_robot_sensing`.
+     */
+    void set_robot_sensing(bool sensing);
+
+    /**
+     * @brief Starts writing the changes of the world to the input log. The
+     * current state of the world is written first, so the world simulated
+     * from the log with the same number of ticks is bit-identical (in
+     * deterministic mode). Only the changes sent by `apply` (and the other
+     * methods that send the changes of `World`) and rewinds are logged.
+     * @param log The input log or `nullptr` to stop logging.
+     */
+    void set_input_log(std::shared_ptr<InputLogWriter> log);
+
+    /**
+     * @brief Sets the maximum memory taken by the history to which the
+     * simulation can be rewound.
+     * @param bytes The memory budget in bytes.
+     */
+    void set_rewind_budget(std::size_t bytes);
+
+    /**
+     * @brief Shows the robots at the given tick of the history in the
+     * snapshots, the world itself is not changed until `rewind`. It should
+     * be used only while the simulation is paused.
+     * @param tick Tick between `WorldSnapshot::history_first` and
+     * `WorldSnapshot::history_last`.
+     */
+    void seek(std::uint64_t tick);
+
+    /**
+     * @brief Rewinds the world to the tick selected by `seek`. The history
+     * after the tick is dropped.
+     * @return State of the rewound world or `nullptr` if no tick was
+     * selected by `seek`.
+     */
+    std::shared_ptr<const WorldState> rewind();
+
+    /**
+     * @brief Checks whether the trajectories of the robots are recorded.
+     */
+    bool is_recording() const { return mrecording; }
+
+    /**
+     * @brief Starts recording the trajectories of the robots to the file
+     * (see `TrajectoryWriter`). Previous recording is finished.
+     * @param filename Path to the trajectory file.
+     * @throws std::runtime_error when the file cannot be created or the
+     * previous recording failed.
+     */
+    void start_recording(const std::string &filename);
+
+    /**
+     * @brief Stops recording and waits until the whole recording is written.
+     * @throws std::runtime_error when writing of the recording failed.
+     */
+    void stop_recording();
+
+    /**
+     * @brief Gets the newest snapshot of the world.
+     * @return The newest snapshot or `nullptr` if it doesn't contain all the
+     * sent commands yet. The snapshot is valid until the next call.
+     */
+    const WorldSnapshot *poll();
+
+private:
+    void run();
+    void save_positions();
+    void publish(std::chrono::steady_clock::time_point time);
+    void measure_rate(std::chrono::steady_clock::time_point now);
+
+    // owned by the simulation thread
+    World world;
+    bool running;
+    double scale;
+    // simulated time that is not ticked yet (seconds)
+    double accumulator;
+    std::uint64_t ticks;
+    std::uint64_t applied;
+    // positions of the robots before the last tick
+    std::vector<double> prev_x;
+    std::vector<double> prev_y;
+    // recent history of the world
+    RewindBuffer history;
+    // tick shown instead of the current state of the world
+    bool seeking;
+    std::uint64_t seek_tick;
+    std::vector<double> seek_x;
+    std::vector<double> seek_y;
+    std::vector<double> seek_angle;
+    // records the trajectories to file, `nullptr` if not recording
+    std::unique_ptr<TrajectoryWriter> recorder;
+    // logs the inputs, `nullptr` if not logging
+    std::shared_ptr<InputLogWriter> input_log;
+    // start of the period in which the rate is measured
+    std::chrono::steady_clock::time_point rate_start;
+    std::uint64_t rate_ticks;
+    double rate;
+
+    // owned by the creating thread
+    bool mrunning;
+    double mtime_scale;
+    bool mrecording;
+    bool mdeterministic;
+    std::uint64_t sent;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    // guarded by `mtx`
+    std::vector<Command> commands;
+    bool stop;
+
+    TripleBuffer<WorldSnapshot> snapshots;
+    // must be last so that everything is initialized before the thread starts
+    std::thread worker;
+};
+
+} // namespace icp
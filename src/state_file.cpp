@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief File with the complete state of the simulation. (source file)
+ */
+
+#include "state_file.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "little_endian.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/** @brief Identifies the state file. */
+static const char MAGIC[8] = { 'I', 'C', 'P', 'S', 'T', 'A', 'T', 'E' };
+
+constexpr size_t HEADER_SIZE = 56;
+constexpr size_t OBSTACLE_SIZE = 5 * 8;
+
+static_assert(sizeof(RobotKind) == 4);
+
+bool is_state_file(const char *data, size_t size) {
+    return size >= sizeof(MAGIC) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool has_state_file_ext(const string &filename) {
+    auto len = strlen(STATE_FILE_EXT);
+    return filename.size() >= len
+        && filename.compare(filename.size() - len, len, STATE_FILE_EXT) == 0;
+}
+
+WorldState load_state_file(const char *data, size_t size) {
+    if (!is_state_file(data, size)) {
+        throw runtime_error("Not a state file");
+    }
+    if (size < HEADER_SIZE) {
+        throw runtime_error("Truncated state file");
+    }
+
+    auto version = read_le<uint32_t>(data + 8);
+    if (version != STATE_FILE_VERSION) {
+        throw runtime_error(
+            "Unsupported state file version " + to_string(version)
+        );
+    }
+
+    WorldState res;
+    res.width = read_le<double>(data + 16);
+    res.height = read_le<double>(data + 24);
+    res.ticks = read_le<uint64_t>(data + 32);
+    auto obstacles = read_le<uint64_t>(data + 40);
+    auto robots = read_le<uint64_t>(data + 48);
+
+    // compare by division so that invalid counts cannot overflow
+    auto rsize = RobotArrays::saved_robot_size();
+    auto rest = size - HEADER_SIZE;
+    if (obstacles > rest / OBSTACLE_SIZE
+        || robots > (rest - obstacles * OBSTACLE_SIZE) / rsize
+        || rest != obstacles * OBSTACLE_SIZE + robots * rsize)
+    {
+        throw runtime_error("Truncated state file");
+    }
+
+    auto p = data + HEADER_SIZE;
+    res.obstacles.resize(obstacles);
+    for (auto &o : res.obstacles) {
+        o.hitbox = Rect{
+            read_le<double>(p),
+            read_le<double>(p + 8),
+            read_le<double>(p + 16),
+            read_le<double>(p + 24),
+        };
+        o.grabbed = read_le<uint8_t>(p + 32);
+        p += OBSTACLE_SIZE;
+    }
+
+    res.robots.for_each_saved_array([&](auto &arr) {
+        using T = typename decay_t<decltype(arr)>::value_type;
+        arr.resize(robots);
+        read_le_array(p, arr.data(), robots);
+        p += robots * sizeof(T);
+    });
+    res.robots.update_directions();
+
+    for (auto kind : res.robots.kind) {
+        if (static_cast<uint32_t>(kind) > 2) {
+            throw runtime_error("Invalid robot kind in state file");
+        }
+    }
+    for (auto rays : res.robots.lidar_rays) {
+        if (rays > MAX_LIDAR_RAYS) {
+            throw runtime_error("Invalid number of lidar rays in state file");
+        }
+    }
+
+    return res;
+}
+
+size_t state_file_size(const WorldState &state) {
+    return HEADER_SIZE
+        + state.obstacles.size() * OBSTACLE_SIZE
+        + state.robots.size() * RobotArrays::saved_robot_size();
+}
+
+/**
+ * @brief Writes the state in the format of the state file to memory.
+ */
+static vector<char> encode(const WorldState &state) {
+    auto &robots = state.robots;
+    vector<char> buf(state_file_size(state), 0);
+
+    memcpy(buf.data(), MAGIC, sizeof(MAGIC));
+    write_le<uint32_t>(buf.data() + 8, STATE_FILE_VERSION);
+    write_le<double>(buf.data() + 16, state.width);
+    write_le<double>(buf.data() + 24, state.height);
+    write_le<uint64_t>(buf.data() + 32, state.ticks);
+    write_le<uint64_t>(buf.data() + 40, state.obstacles.size());
+    write_le<uint64_t>(buf.data() + 48, robots.size());
+
+    auto p = buf.data() + HEADER_SIZE;
+    for (auto &o : state.obstacles) {
+        write_le<double>(p, o.hitbox.x);
+        write_le<double>(p + 8, o.hitbox.y);
+        write_le<double>(p + 16, o.hitbox.w);
+        write_le<double>(p + 24, o.hitbox.h);
+        write_le<uint8_t>(p + 32, o.grabbed);
+        p += OBSTACLE_SIZE;
+    }
+
+    robots.for_each_saved_array([&](auto &arr) {
+        using T = typename decay_t<decltype(arr)>::value_type;
+        write_le_array(p, arr.data(), arr.size());
+        p += arr.size() * sizeof(T);
+    });
+
+    return buf;
+}
+
+void save_state_file(const WorldState &state, ostream &out) {
+    auto buf = encode(state);
+    out.write(buf.data(), buf.size());
+}
+
+uint64_t state_hash(const WorldState &state) {
+    // FNV-1a
+    uint64_t res = 0xcbf29ce484222325;
+    for (auto c : encode(state)) {
+        res = (res ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    }
+    return res;
+}
+
+} // namespace icp
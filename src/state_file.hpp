@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief File with the complete state of the simulation. (header file)
+ *
+ * All the values are little-endian. The file starts with header:
+ *  - magic `ICPSTATE` (8 bytes)
+ *  - version (u32), currently `STATE_FILE_VERSION`
+ *  - reserved (u32), zero
+ *  - width and height of the room (f64 each)
+ *  - number of simulated ticks (u64)
+ *  - number of obstacles (u64)
+ *  - number of robots (u64)
+ *
+ * Then there are the obstacles, each of them is x, y, width and height of
+ * its hitbox (f64 each), grabbed flag (u8) and 7 reserved zero bytes. After
+ * them there are the arrays of `RobotArrays` one after another in the order
+ * in which they are declared, each with one item per robot: kinds (u32,
+ * values of `RobotKind`), then the floating point arrays (f64), the numbers
+ * of the rays of the lidars (u32) and the grabbed flags (u8). The directions
+ * of the robots (`dir_x` and `dir_y`) are not stored, they are computed from
+ * the angles when the file is loaded.
+ *
+ * The arrays are stored as they are in memory, so the capture and restore is
+ * just copy of memory on little-endian machines.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "world.hpp"
+
+namespace icp {
+
+/**
+ * @brief Version of the state file written by `save_state_file`.
+ */
+constexpr std::uint32_t STATE_FILE_VERSION = 2;
+
+/**
+ * @brief Extension of files that are saved as state file.
+ */
+constexpr const char *STATE_FILE_EXT = ".state";
+
+/**
+ * @brief Checks whether the data start with the header of the state file.
+ */
+bool is_state_file(const char *data, std::size_t size);
+
+/**
+ * @brief Checks whether the file should be saved as state file (based on
+ * its extension).
+ */
+bool has_state_file_ext(const std::string &filename);
+
+/**
+ * @brief Loads the state of the world from the state file.
+ * @param data Contents of the file.
+ * @param size Size of the contents in bytes.
+ * @throws std::runtime_error when the data are not valid.
+ */
+WorldState load_state_file(const char *data, std::size_t size);
+
+/**
+ * @brief Gets the size of the state file with the given state in bytes.
+ */
+std::size_t state_file_size(const WorldState &state);
+
+/**
+ * @brief Saves the state of the world to the state file.
+ * @param state State to save.
+ * @param out Stream to write to (it should be opened in binary mode).
+ */
+void save_state_file(const WorldState &state, std::ostream &out);
+
+/**
+ * @brief Calculates hash of the state of the world from the contents of its
+ * state file. Worlds with the same hash are bit-identical (with high
+ * probability), it is used to compare the results of simulations.
+ */
+std::uint64_t state_hash(const WorldState &state);
+
+} // namespace icp
@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Buffered writer of text with fast number formatting. (source file)
+ */
+
+#include "text_writer.hpp"
+
+#include <charconv>
+#include <cstring>
+
+namespace icp {
+
+using namespace std;
+
+/**
+ * @brief Maximum length of number formatted by `TextWriter`.
+ */
+constexpr size_t MAX_NUMBER_LEN = 32;
+
+/**
+ * @brief Number of significant digits, the default precision of
+ * `std::ostream`.
+ */
+constexpr int PRECISION = 6;
+
+//---------------------------------------------------------------------------//
+//                                   Sinks                                   //
+//---------------------------------------------------------------------------//
+
+void StreamSink::write(const char *data, size_t size) {
+    out.write(data, size);
+}
+
+void StringSink::write(const char *data, size_t size) {
+    str.append(data, size);
+}
+
+void MemorySink::write(const char *data, size_t size) {
+    mdata.insert(mdata.end(), data, data + size);
+}
+
+//---------------------------------------------------------------------------//
+//                                TextWriter                                 //
+//---------------------------------------------------------------------------//
+
+TextWriter &TextWriter::operator<<(string_view str) {
+    if (len + str.size() > BUFFER_SIZE) {
+        flush();
+        if (str.size() > BUFFER_SIZE) {
+            sink.write(str.data(), str.size());
+            return *this;
+        }
+    }
+
+    memcpy(buf + len, str.data(), str.size());
+    len += str.size();
+    return *this;
+}
+
+TextWriter &TextWriter::operator<<(char c) {
+    if (len == BUFFER_SIZE) {
+        flush();
+    }
+    buf[len++] = c;
+    return *this;
+}
+
+TextWriter &TextWriter::operator<<(double num) {
+    if (len + MAX_NUMBER_LEN > BUFFER_SIZE) {
+        flush();
+    }
+
+    // same as `printf("%g")` which is used by `std::ostream`
+    auto res = to_chars(
+        buf + len, buf + BUFFER_SIZE, num, chars_format::general, PRECISION
+    );
+    len = res.ptr - buf;
+    return *this;
+}
+
+void TextWriter::flush() {
+    if (len != 0) {
+        sink.write(buf, len);
+        len = 0;
+    }
+}
+
+} // namespace icp
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Buffered writer of text with fast number formatting. (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace icp {
+
+/**
+ * @brief Destination of the text written by `TextWriter`.
+ */
+class Sink {
+public:
+    virtual ~Sink() = default;
+
+    /**
+     * @brief Writes chunk of data.
+     */
+    virtual void write(const char *data, std::size_t size) = 0;
+};
+
+/**
+ * @brief Writes to output stream (e.g. file).
+ */
+class StreamSink : public Sink {
+public:
+    StreamSink(std::ostream &out) : out(out) {}
+
+    void write(const char *data, std::size_t size) override;
+
+private:
+    std::ostream &out;
+};
+
+/**
+ * @brief Appends to string.
+ */
+class StringSink : public Sink {
+public:
+    StringSink(std::string &str) : str(str) {}
+
+    void write(const char *data, std::size_t size) override;
+
+private:
+    std::string &str;
+};
+
+/**
+ * @brief Collects the data in memory. The memory is kept when it is
+ * cleared, so the sink can be reused without allocations.
+ */
+class MemorySink : public Sink {
+public:
+    void write(const char *data, std::size_t size) override;
+
+    /**
+     * @brief Gets the written data.
+     */
+    const std::vector<char> &data() const { return mdata; }
+
+    /**
+     * @brief Removes the written data.
+     */
+    void clear() { mdata.clear(); }
+
+private:
+    std::vector<char> mdata;
+};
+
+/**
+ * @brief Formats text into large buffer that is written to the sink only
+ * when it is full (or flushed). Numbers are formatted with `std::to_chars`
+ * the same way as by `std::ostream` with the default settings.
+ */
+class TextWriter {
+public:
+    /**
+     * @brief Size of the buffer.
+     */
+    static constexpr std::size_t BUFFER_SIZE = 32 * 1024;
+
+    TextWriter(Sink &sink) : sink(sink), len(0) {}
+
+    TextWriter(const TextWriter &) = delete;
+    TextWriter &operator=(const TextWriter &) = delete;
+
+    /**
+     * @brief Writes the rest of the buffer.
+     */
+    ~TextWriter() { flush(); }
+
+    TextWriter &operator<<(std::string_view str);
+    TextWriter &operator<<(char c);
+    TextWriter &operator<<(double num);
+
+    /**
+     * @brief Writes the buffered text to the sink.
+     */
+    void flush();
+
+private:
+    Sink &sink;
+    char buf[BUFFER_SIZE];
+    std::size_t len;
+};
+
+} // namespace icp
@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Compact encoding of the movement of the robots. (source file)
+ */
+
+#include "track_coder.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "world.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/**
+ * @brief Quantizes the value to the multiple of the step.
+ */
+static int64_t quantize(double val, double step) {
+    return llround(val / step);
+}
+
+/**
+ * @brief Calculates the difference of the quantized value from its
+ * prediction and moves the history of the value.
+ * @param prev The value before the last tick.
+ * @param cur The value in the last tick.
+ * @param val The new value.
+ * @return Difference of the new value from the prediction.
+ */
+static int64_t predict(int64_t &prev, int64_t &cur, int64_t val) {
+    auto res = val - (2 * cur - prev);
+    prev = cur;
+    cur = val;
+    return res;
+}
+
+/**
+ * @brief Reverse of `predict`, calculates the new value from its difference
+ * from the prediction and moves the history of the value.
+ */
+static void unpredict(int64_t &prev, int64_t &cur, int64_t diff) {
+    auto val = 2 * cur - prev + diff;
+    prev = cur;
+    cur = val;
+}
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+void TrackCoder::reset(const RobotArrays &robots) {
+    auto n = robots.size();
+    x[0].resize(n);
+    x[1].resize(n);
+    y[0].resize(n);
+    y[1].resize(n);
+    angle[0].resize(n);
+    angle[1].resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        x[0][i] = x[1][i] = quantize(robots.x[i], POS_STEP);
+        y[0][i] = y[1][i] = quantize(robots.y[i], POS_STEP);
+        angle[0][i] = angle[1][i] = quantize(robots.angle[i], ANGLE_STEP);
+    }
+}
+
+void TrackCoder::encode(
+    const RobotArrays &robots,
+    vector<unsigned char> &out
+) {
+    for (size_t i = 0; i < size(); ++i) {
+        put_varint(out, predict(
+            x[0][i], x[1][i], quantize(robots.x[i], POS_STEP)
+        ));
+        put_varint(out, predict(
+            y[0][i], y[1][i], quantize(robots.y[i], POS_STEP)
+        ));
+        put_varint(out, predict(
+            angle[0][i], angle[1][i], quantize(robots.angle[i], ANGLE_STEP)
+        ));
+    }
+}
+
+void TrackCoder::decode(const unsigned char *&p, const unsigned char *end) {
+    for (size_t i = 0; i < size(); ++i) {
+        unpredict(x[0][i], x[1][i], get_varint(p, end));
+        unpredict(y[0][i], y[1][i], get_varint(p, end));
+        unpredict(angle[0][i], angle[1][i], get_varint(p, end));
+    }
+}
+
+void TrackCoder::get(
+    vector<double> &x,
+    vector<double> &y,
+    vector<double> &angle
+) const {
+    x.resize(size());
+    y.resize(size());
+    angle.resize(size());
+    for (size_t i = 0; i < size(); ++i) {
+        x[i] = this->x[1][i] * POS_STEP;
+        y[i] = this->y[1][i] * POS_STEP;
+        angle[i] = this->angle[1][i] * ANGLE_STEP;
+    }
+}
+
+void TrackCoder::put_varint(vector<unsigned char> &out, int64_t val) {
+    auto u = (static_cast<uint64_t>(val) << 1)
+        ^ static_cast<uint64_t>(val >> 63);
+    while (u >= 0x80) {
+        out.push_back((u & 0x7f) | 0x80);
+        u >>= 7;
+    }
+    out.push_back(u);
+}
+
+int64_t TrackCoder::get_varint(
+    const unsigned char *&p,
+    const unsigned char *end
+) {
+    uint64_t u = 0;
+    unsigned shift = 0;
+    while (p != end && (*p & 0x80) && shift < 63) {
+        u |= uint64_t(*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    if (p == end) {
+        throw runtime_error("Truncated variable length integer");
+    }
+    u |= uint64_t(*p++) << shift;
+    return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+}
+
+} // namespace icp
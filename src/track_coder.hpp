@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Compact encoding of the movement of the robots. (header file)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace icp {
+
+struct RobotArrays;
+
+/**
+ * @brief Encodes the positions and angles of the robots in consecutive
+ * ticks. The values are quantized and only the difference from their
+ * prediction (the same change as in the previous tick) is stored as zigzag
+ * encoded variable length integer, so robots that move straight take only a
+ * byte per value. The decoder must be reset to the same robots as the
+ * encoder.
+ */
+class TrackCoder {
+public:
+    /**
+     * @brief Size of the quantization step of the positions in pixels.
+     */
+    static constexpr double POS_STEP = 1. / 256;
+
+    /**
+     * @brief Size of the quantization step of the angles in radians.
+     */
+    static constexpr double ANGLE_STEP = 1. / 65536;
+
+    /**
+     * @brief Starts encoding/decoding from the given robots. Their previous
+     * movement is considered to be zero.
+     */
+    void reset(const RobotArrays &robots);
+
+    /**
+     * @brief Appends the positions and angles of the robots in the next
+     * tick. There must be the same number of robots as in `reset`.
+     * @param robots The robots in the next tick.
+     * @param out Where to append the encoded tick.
+     */
+    void encode(const RobotArrays &robots, std::vector<unsigned char> &out);
+
+    /**
+     * @brief Decodes the next tick.
+     * @param p Start of the encoded tick, it is moved after it.
+     * @param end End of the encoded data.
+     * @throws std::runtime_error when the data end before the tick.
+     */
+    void decode(const unsigned char *&p, const unsigned char *end);
+
+    /**
+     * @brief Gets the number of the robots.
+     */
+    std::size_t size() const { return x[1].size(); }
+
+    /**
+     * @brief Gets the positions and angles of the robots in the last encoded
+     * or decoded tick (rounded to `POS_STEP` and `ANGLE_STEP`).
+     * @param x Left edges of the hitboxes of the robots.
+     * @param y Top edges of the hitboxes of the robots.
+     * @param angle Angles of the robots.
+     */
+    void get(
+        std::vector<double> &x,
+        std::vector<double> &y,
+        std::vector<double> &angle
+    ) const;
+
+    /**
+     * @brief Appends signed value as zigzag encoded variable length integer
+     * (7 bits per byte, small values of both signs take one byte).
+     */
+    static void put_varint(std::vector<unsigned char> &out, std::int64_t val);
+
+    /**
+     * @brief Reads value written by `put_varint` and moves after it.
+     * @throws std::runtime_error when the data end before the value.
+     */
+    static std::int64_t get_varint(
+        const unsigned char *&p,
+        const unsigned char *end
+    );
+
+private:
+    // quantized values in the tick before the last and in the last tick
+    std::vector<std::int64_t> x[2];
+    std::vector<std::int64_t> y[2];
+    std::vector<std::int64_t> angle[2];
+};
+
+} // namespace icp
@@ -0,0 +1,321 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Recording and replaying of the trajectories of the robots. (source
+ * file)
+ */
+
+#include "trajectory.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "little_endian.hpp"
+#include "state_file.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/** @brief Identifies the trajectory file. */
+static const char MAGIC[8] = { 'I', 'C', 'P', 'T', 'R', 'A', 'J', 0 };
+
+constexpr size_t HEADER_SIZE = 16;
+
+/**
+ * @brief Writes little-endian u64 to the stream.
+ */
+static void put_u64(ostream &out, uint64_t val) {
+    char buf[8];
+    write_le(buf, val);
+    out.write(buf, sizeof(buf));
+}
+
+/**
+ * @brief Reads little-endian u64 and moves after it.
+ * @throws std::runtime_error when the data end before the value.
+ */
+static uint64_t get_u64(const char *&p, const char *end) {
+    if (end - p < 8) {
+        throw runtime_error("Truncated trajectory file");
+    }
+    auto res = read_le<uint64_t>(p);
+    p += 8;
+    return res;
+}
+
+bool is_trajectory(const char *data, size_t size) {
+    return size >= sizeof(MAGIC) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool has_trajectory_ext(const string &filename) {
+    auto len = strlen(TRAJECTORY_EXT);
+    return filename.size() >= len
+        && filename.compare(filename.size() - len, len, TRAJECTORY_EXT) == 0;
+}
+
+//---------------------------------------------------------------------------//
+//                             TRAJECTORY WRITER                             //
+//---------------------------------------------------------------------------//
+
+TrajectoryWriter::TrajectoryWriter(const string &filename, uint64_t keyframe) :
+    out(filename, ios::binary),
+    keyframe_len(max<uint64_t>(keyframe, 1)),
+    seg(),
+    recording(false),
+    coder(),
+    mtx(),
+    cv(),
+    queue(),
+    stop(false),
+    failed(false),
+    worker()
+{
+    if (!out) {
+        throw runtime_error("Failed to create the file '" + filename + "'");
+    }
+
+    char header[HEADER_SIZE] = { 0 };
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    write_le<uint32_t>(header + 8, TRAJECTORY_VERSION);
+    out.write(header, sizeof(header));
+
+    worker = thread(&TrajectoryWriter::run, this);
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    if (worker.joinable()) {
+        try {
+            finish();
+        } catch (...) {
+            // there is no one to report the error to
+        }
+    }
+}
+
+void TrajectoryWriter::record(const World &world, bool changed) {
+    auto tick = world.ticks();
+    auto last = seg.key.ticks + seg.count;
+
+    if (!recording
+        || changed
+        || tick != last + 1
+        || seg.key.robots.size() != world.robots().size()
+        || seg.count + 1 >= keyframe_len)
+    {
+        // empty segment at the same tick would be replaced by the new one
+        if (recording && (seg.count != 0 || seg.key.ticks != tick)) {
+            end_segment();
+        }
+        start_segment(world);
+        return;
+    }
+
+    coder.encode(world.robots(), seg.data);
+    ++seg.count;
+}
+
+void TrajectoryWriter::finish() {
+    if (!worker.joinable()) {
+        return;
+    }
+
+    if (recording) {
+        end_segment();
+        recording = false;
+    }
+
+    {
+        lock_guard<mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+
+    out.close();
+    if (failed || !out) {
+        throw runtime_error("Failed to write the trajectory file");
+    }
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+void TrajectoryWriter::start_segment(const World &world) {
+    // the new segment will have about the same size as the previous one
+    auto reserve = seg.data.capacity();
+    seg = Segment{ world.state(), 0, {} };
+    seg.data.reserve(reserve);
+    coder.reset(seg.key.robots);
+    recording = true;
+}
+
+void TrajectoryWriter::end_segment() {
+    unique_lock<mutex> lock(mtx);
+    // don't let the recording take unbounded memory if the disk is slow
+    cv.wait(lock, [&] { return queue.size() < MAX_QUEUE || failed; });
+    if (failed) {
+        return;
+    }
+    queue.push_back(std::move(seg));
+    lock.unlock();
+    cv.notify_all();
+}
+
+void TrajectoryWriter::run() {
+    while (true) {
+        unique_lock<mutex> lock(mtx);
+        cv.wait(lock, [&] { return !queue.empty() || stop; });
+        if (queue.empty()) {
+            return;
+        }
+        auto s = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        cv.notify_all();
+
+        put_u64(out, s.key.ticks);
+        put_u64(out, s.count);
+        put_u64(out, state_file_size(s.key));
+        save_state_file(s.key, out);
+        put_u64(out, s.data.size());
+        out.write(
+            reinterpret_cast<const char *>(s.data.data()),
+            s.data.size()
+        );
+
+        if (!out) {
+            lock.lock();
+            failed = true;
+            queue.clear();
+            lock.unlock();
+            cv.notify_all();
+            return;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------//
+//                             TRAJECTORY READER                             //
+//---------------------------------------------------------------------------//
+
+TrajectoryReader::TrajectoryReader(const string &filename) :
+    file(filename),
+    segments(),
+    cur(0),
+    mtick(0),
+    key(),
+    coder(),
+    next(nullptr)
+{
+    auto p = file.data();
+    auto end = p + file.size();
+    if (!is_trajectory(p, file.size())) {
+        throw runtime_error("Not a trajectory file");
+    }
+    if (file.size() < HEADER_SIZE) {
+        throw runtime_error("Truncated trajectory file");
+    }
+
+    auto version = read_le<uint32_t>(p + 8);
+    if (version != TRAJECTORY_VERSION) {
+        throw runtime_error(
+            "Unsupported trajectory file version " + to_string(version)
+        );
+    }
+    p += HEADER_SIZE;
+
+    while (p != end) {
+        Segment seg;
+        seg.first = get_u64(p, end);
+        seg.count = get_u64(p, end);
+        seg.key_size = get_u64(p, end);
+        if (seg.key_size > size_t(end - p)) {
+            throw runtime_error("Truncated trajectory file");
+        }
+        seg.key = p;
+        p += seg.key_size;
+        seg.data_size = get_u64(p, end);
+        if (seg.data_size > size_t(end - p)) {
+            throw runtime_error("Truncated trajectory file");
+        }
+        seg.data = reinterpret_cast<const unsigned char *>(p);
+        p += seg.data_size;
+
+        if (!segments.empty() && seg.first < segments.back().first) {
+            throw runtime_error("Invalid order of ticks in trajectory file");
+        }
+        segments.push_back(seg);
+    }
+
+    if (segments.empty()) {
+        throw runtime_error("Empty trajectory file");
+    }
+
+    load_segment(0);
+}
+
+uint64_t TrajectoryReader::last() const {
+    return segments.back().first + segments.back().count;
+}
+
+uint64_t TrajectoryReader::seek(uint64_t tick) {
+    // the newest segment that starts before the tick, when the world was
+    // changed, the segment after the change starts at the same tick as the
+    // previous one ends
+    auto seg = upper_bound(
+        segments.begin(),
+        segments.end(),
+        tick,
+        [](uint64_t t, const Segment &s) { return t < s.first; }
+    );
+    if (seg != segments.begin()) {
+        --seg;
+    }
+    tick = clamp(tick, seg->first, seg->first + seg->count);
+
+    size_t idx = seg - segments.begin();
+    if (idx != cur || tick < mtick) {
+        load_segment(idx);
+    }
+
+    auto end = seg->data + seg->data_size;
+    for (; mtick < tick; ++mtick) {
+        coder.decode(next, end);
+    }
+    return mtick;
+}
+
+void TrajectoryReader::positions(
+    vector<double> &x,
+    vector<double> &y,
+    vector<double> &angle
+) const {
+    if (mtick == key.ticks) {
+        x = key.robots.x;
+        y = key.robots.y;
+        angle = key.robots.angle;
+    } else {
+        coder.get(x, y, angle);
+    }
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+void TrajectoryReader::load_segment(size_t idx) {
+    auto &seg = segments[idx];
+    key = load_state_file(seg.key, seg.key_size);
+    if (key.ticks != seg.first) {
+        throw runtime_error("Invalid keyframe in trajectory file");
+    }
+    coder.reset(key.robots);
+    next = seg.data;
+    mtick = seg.first;
+    cur = idx;
+}
+
+} // namespace icp
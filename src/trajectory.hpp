@@ -0,0 +1,237 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Recording and replaying of the trajectories of the robots. (header
+ * file)
+ *
+ * All the values are little-endian. The file starts with header:
+ *  - magic `ICPTRAJ` followed by zero byte (8 bytes)
+ *  - version (u32), currently `TRAJECTORY_VERSION`
+ *  - reserved (u32), zero
+ *
+ * Then there are segments of consecutive ticks, each of them is:
+ *  - the first tick of the segment (u64)
+ *  - number of the ticks after the first tick (u64)
+ *  - size of the keyframe (u64)
+ *  - the keyframe, state of the world at the first tick in the format of
+ *    state file (see `state_file.hpp`)
+ *  - size of the encoded ticks (u64)
+ *  - positions and angles of the robots in the ticks after the first tick
+ *    encoded by `TrackCoder`
+ *
+ * New segment starts every `TRAJECTORY_KEYFRAME` ticks and whenever the
+ * world is changed by other means than tick.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "track_coder.hpp"
+#include "world.hpp"
+
+namespace icp {
+
+/**
+ * @brief Version of the trajectory file written by `TrajectoryWriter`.
+ */
+constexpr std::uint32_t TRAJECTORY_VERSION = 1;
+
+/**
+ * @brief Extension of the trajectory files.
+ */
+constexpr const char *TRAJECTORY_EXT = ".traj";
+
+/**
+ * @brief Maximum number of ticks between two keyframes of the trajectory
+ * file.
+ */
+constexpr std::uint64_t TRAJECTORY_KEYFRAME = 1000;
+
+/**
+ * @brief Checks whether the data start with the header of the trajectory
+ * file.
+ */
+bool is_trajectory(const char *data, std::size_t size);
+
+/**
+ * @brief Checks whether the file is trajectory file (based on its
+ * extension).
+ */
+bool has_trajectory_ext(const std::string &filename);
+
+/**
+ * @brief Records the trajectories of the robots to file. The ticks are
+ * encoded on the recording thread and the finished segments are written to
+ * the file by background thread.
+ */
+class TrajectoryWriter {
+public:
+    /**
+     * @brief Maximum number of finished segments waiting for the background
+     * thread. Recording waits when there are more of them.
+     */
+    static constexpr std::size_t MAX_QUEUE = 16;
+
+    /**
+     * @brief Creates the file and starts the background thread.
+     * @param filename Path to the file.
+     * @param keyframe Maximum number of ticks between two keyframes.
+     * @throws std::runtime_error when the file cannot be created.
+     */
+    TrajectoryWriter(
+        const std::string &filename,
+        std::uint64_t keyframe = TRAJECTORY_KEYFRAME
+    );
+
+    TrajectoryWriter(const TrajectoryWriter &) = delete;
+    TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+
+    /**
+     * @brief Writes the rest of the recording and waits for the background
+     * thread.
+     */
+    ~TrajectoryWriter();
+
+    /**
+     * @brief Records the current positions of the robots. It is called after
+     * each tick and after each change of the world.
+     * @param world The recorded world.
+     * @param changed `true` if the world was changed by other means than
+     * tick.
+     */
+    void record(const World &world, bool changed = false);
+
+    /**
+     * @brief Writes the rest of the recording and closes the file.
+     * @throws std::runtime_error when writing to the file failed.
+     */
+    void finish();
+
+private:
+    struct Segment {
+        WorldState key;
+        std::uint64_t count;
+        std::vector<unsigned char> data;
+    };
+
+    void start_segment(const World &world);
+    void end_segment();
+    void run();
+
+    std::ofstream out;
+    std::uint64_t keyframe_len;
+
+    // owned by the recording thread
+    Segment seg;
+    bool recording;
+    TrackCoder coder;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    // guarded by `mtx`
+    std::deque<Segment> queue;
+    bool stop;
+    bool failed;
+
+    // must be last so that everything is initialized before the thread starts
+    std::thread worker;
+};
+
+/**
+ * @brief Plays the recorded trajectories from file. The file is mapped to
+ * memory and only the segment with the current tick is decoded.
+ */
+class TrajectoryReader {
+public:
+    /**
+     * @brief Opens the file and finds the segments in it.
+     * @param filename Path to the file.
+     * @throws std::runtime_error when the file is not valid.
+     */
+    TrajectoryReader(const std::string &filename);
+
+    /**
+     * @brief Gets the first recorded tick.
+     */
+    std::uint64_t first() const { return segments.front().first; }
+
+    /**
+     * @brief Gets the last recorded tick.
+     */
+    std::uint64_t last() const;
+
+    /**
+     * @brief Moves to the given tick. Moving forward within the segment
+     * decodes only the ticks in between.
+     * @param tick The tick to move to. If it wasn't recorded, it moves to
+     * the nearest later recorded tick (or to the last tick).
+     * @return The tick to which it moved.
+     * @throws std::runtime_error when the file is not valid.
+     */
+    std::uint64_t seek(std::uint64_t tick);
+
+    /**
+     * @brief Gets the current tick.
+     */
+    std::uint64_t tick() const { return mtick; }
+
+    /**
+     * @brief Gets index of the segment with the current tick. The segment
+     * changes when the world was changed while recording.
+     */
+    std::size_t segment() const { return cur; }
+
+    /**
+     * @brief Gets the state of the world at the start of the current segment
+     * (e.g. the kinds of the robots and the obstacles).
+     */
+    const WorldState &keyframe() const { return key; }
+
+    /**
+     * @brief Gets the positions and angles of the robots at the current
+     * tick.
+     * @param x Left edges of the hitboxes of the robots.
+     * @param y Top edges of the hitboxes of the robots.
+     * @param angle Angles of the robots.
+     */
+    void positions(
+        std::vector<double> &x,
+        std::vector<double> &y,
+        std::vector<double> &angle
+    ) const;
+
+private:
+    struct Segment {
+        std::uint64_t first;
+        std::uint64_t count;
+        const char *key;
+        std::size_t key_size;
+        const unsigned char *data;
+        std::size_t data_size;
+    };
+
+    void load_segment(std::size_t idx);
+
+    MappedFile file;
+    std::vector<Segment> segments;
+
+    // index of the current segment
+    std::size_t cur;
+    std::uint64_t mtick;
+    WorldState key;
+    TrackCoder coder;
+    // encoded data of the next tick
+    const unsigned char *next;
+};
+
+} // namespace icp
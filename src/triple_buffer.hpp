@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Lock free handoff of values between two threads. (header file)
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace icp {
+
+/**
+ * @brief Three buffers shared by one writing and one reading thread. The
+ * writer fills the back buffer and publishes it, the reader takes the newest
+ * published buffer. Neither of them ever waits for the other and the reader
+ * always sees a whole value.
+ */
+template<typename T> class TripleBuffer {
+public:
+    /**
+     * @brief Gets the buffer to be filled by the writer.
+     */
+    T &back() { return bufs[mback]; }
+
+    /**
+     * @brief Publishes the back buffer to the reader (writer only).
+     */
+    void publish() {
+        mback = ready.exchange(mback | FRESH, std::memory_order_acq_rel)
+            & INDEX;
+    }
+
+    /**
+     * @brief Makes the newest published buffer the front buffer (reader
+     * only).
+     * @return `true` if there was new buffer.
+     */
+    bool update() {
+        if (!(ready.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        mfront = ready.exchange(mfront, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /**
+     * @brief Gets the buffer last taken by the reader.
+     */
+    const T &front() const { return bufs[mfront]; }
+
+private:
+    static constexpr unsigned INDEX = 3;
+    // set when the ready buffer wasn't taken by the reader yet
+    static constexpr unsigned FRESH = 4;
+
+    T bufs[3];
+    unsigned mback = 0;
+    unsigned mfront = 1;
+    std::atomic<unsigned> ready{ 2 };
+};
+
+} // namespace icp
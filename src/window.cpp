@@ -6,24 +6,45 @@
 
 #include "window.hpp"
 
+#include <chrono>
+#include <fstream>
 #include <memory>
+#include <stdexcept>
 
+#include <QFontDatabase>
 #include <QGraphicsView>
 #include <QResizeEvent>
 #include <QMessageBox>
+#include <QTimerEvent>
 
 #include "obstacle.hpp"
 #include "auto_robot.hpp"
+#include "binary_room.hpp"
+#include "state_file.hpp"
+#include "trajectory.hpp"
 
 namespace icp {
 
 using namespace std;
 
+/**
+ * @brief How often are the durations in the profile overlay refreshed.
+ */
+constexpr chrono::milliseconds PROFILE_REFRESH(500);
+
 //---------------------------------------------------------------------------//
 //                                  PUBLIC                                   //
 //---------------------------------------------------------------------------//
 
-Window::Window(QWidget *parent) : QWidget(parent) {
+Window::Window(QWidget *parent) :
+    QWidget(parent),
+    profile_timer(0),
+    rewind_budget(REWIND_BUDGET),
+    deterministic(false),
+    sensing(Sensing::Tree),
+    robot_sensing(true),
+    input_log()
+{
     setGeometry(0, 0, 900, 600);
 
     room = new Room();
@@ -44,15 +65,76 @@ Window::Window(QWidget *parent) : QWidget(parent) {
     menu_button->setGeometry(5, 45, 54, 30);
     connect(menu_button, &QPushButton::clicked, this, &Window::show_menu);
 
+    profile_overlay = new QLabel(this);
+    profile_overlay->move(5, 80);
+    profile_overlay->setFont(
+        QFontDatabase::systemFont(QFontDatabase::FixedFont)
+    );
+    profile_overlay->setStyleSheet(
+        "background-color: rgba(0, 0, 0, 160); color: white; padding: 4px;"
+    );
+    profile_overlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+    profile_overlay->hide();
+
     menu = new Menu(QSize(800, 600 - 40 * 2), this);
     menu->setGeometry(0, 40, 800, 600 - 40 * 2);
 
     sim_controls = new SimControls(QRect(0, 600 - 40, width(), 40), this);
     connect(sim_controls, &SimControls::load_room, this, &Window::load);
+    connect(sim_controls, &SimControls::save_room, this, &Window::save);
+    connect(
+        sim_controls,
+        &SimControls::start_recording,
+        this,
+        &Window::start_recording
+    );
+    connect(
+        sim_controls,
+        &SimControls::stop_recording,
+        this,
+        &Window::stop_recording
+    );
+    connect(
+        sim_controls,
+        &SimControls::show_profile,
+        this,
+        &Window::show_profile
+    );
 
     room_listeners();
 }
 
+Window::~Window() {
+    if (io.joinable()) {
+        io.join();
+    }
+}
+
+void Window::set_rewind_budget(size_t bytes) {
+    rewind_budget = bytes;
+    room->set_rewind_budget(bytes);
+}
+
+void Window::set_deterministic(bool deterministic) {
+    this->deterministic = deterministic;
+    room->set_deterministic(deterministic);
+}
+
+void Window::set_sensing(Sensing sensing) {
+    this->sensing = sensing;
+    room->set_sensing(sensing);
+}
+
+void Window::set_robot_sensing(bool sensing) {
+    robot_sensing = sensing;
+    room->set_robot_sensing(sensing);
+}
+
+void Window::set_input_log(const string &filename) {
+    input_log = make_shared<InputLogWriter>(filename);
+    room->set_input_log(input_log);
+}
+
 //---------------------------------------------------------------------------//
 //                                PROTECTED                                  //
 //---------------------------------------------------------------------------//
@@ -67,6 +149,12 @@ void Window::resizeEvent(QResizeEvent *event) {
     redit_menu->relayout(QRect(0, 0, size.width(), 40));
 }
 
+void Window::timerEvent(QTimerEvent *event) {
+    if (event->timerId() == profile_timer) {
+        update_profile();
+    }
+}
+
 //---------------------------------------------------------------------------//
 //                               PRIVATE SLOTS                               //
 //---------------------------------------------------------------------------//
@@ -75,29 +163,206 @@ void Window::show_menu() {
     menu->show();
 }
 
+void Window::show_profile(bool show) {
+    if (!show) {
+        killTimer(profile_timer);
+        profile_timer = 0;
+        profile_overlay->hide();
+        return;
+    }
+
+    update_profile();
+    profile_overlay->show();
+    profile_overlay->raise();
+    profile_timer = startTimer(PROFILE_REFRESH);
+}
+
 void Window::load(std::string filename) {
-    Room *new_room;
-    auto loader = Loader(filename);
+    start_io();
+    io = thread([this, filename] {
+        auto world = make_shared<World>();
+        try {
+            if (has_trajectory_ext(filename)) {
+                // the reader is moved to the GUI thread in shared pointer
+                auto replay = make_shared<unique_ptr<TrajectoryReader>>(
+                    make_unique<TrajectoryReader>(filename)
+                );
+                finish_io([this, replay] {
+                    show_replay(std::move(*replay));
+                });
+                return;
+            }
+            *world = Loader(filename).load(io_progress());
+        } catch (const exception &e) {
+            string error = e.what();
+            finish_io([error] {
+                QMessageBox::critical(
+                    nullptr,
+                    "Error loading room",
+                    error.c_str()
+                );
+            });
+            return;
+        }
+        finish_io([this, world] { show_room(std::move(*world)); });
+    });
+}
+
+void Window::save(std::string filename) {
+    // the simulation keeps running while the copy is saved
+    auto complete = has_state_file_ext(filename);
+    auto state = room->capture();
+    start_io();
+    io = thread([this, filename, complete, state] {
+        auto binary = complete || has_binary_room_ext(filename);
+        ofstream file(filename, binary ? ios::binary : ios::out);
+        if (!file.is_open()) {
+            finish_io([] {
+                QMessageBox::critical(
+                    nullptr,
+                    "Error saving room", "File cannot be accessed"
+                );
+            });
+            return;
+        }
+
+        try {
+            if (complete) {
+                save_state_file(*state, file);
+            } else if (binary) {
+                save_binary_room(*state, file);
+            } else {
+                state->save(file, io_progress());
+            }
+            // the last data are written when the file is closed
+            file.close();
+            if (file.fail()) {
+                throw runtime_error("Failed to write the file");
+            }
+        } catch (const exception &e) {
+            string error = e.what();
+            finish_io([error] {
+                QMessageBox::critical(
+                    nullptr,
+                    "Error saving room",
+                    error.c_str()
+                );
+            });
+            return;
+        }
+
+        finish_io([] {
+            QMessageBox::information(
+                nullptr,
+                "Success",
+                "The room was successfully saved"
+            );
+        });
+    });
+}
+
+void Window::start_recording(std::string filename) {
     try {
-        new_room = loader.load(this);
+        room->start_recording(filename);
     } catch (const exception &e) {
-        QMessageBox::critical(nullptr, "Error loading room", e.what());
-        return;
+        sim_controls->set_recording(false);
+        QMessageBox::critical(nullptr, "Error recording", e.what());
+    }
+}
+
+void Window::stop_recording() {
+    try {
+        room->stop_recording();
+    } catch (const exception &e) {
+        QMessageBox::critical(nullptr, "Error recording", e.what());
+    }
+}
+
+//---------------------------------------------------------------------------//
+//                                  PRIVATE                                  //
+//---------------------------------------------------------------------------//
+
+void Window::show_room(World world) {
+    auto width = world.width();
+    auto height = world.height();
+    replace_room(new Room(std::move(world)), width, height);
+}
+
+void Window::show_replay(unique_ptr<TrajectoryReader> replay) {
+    auto width = replay->keyframe().width;
+    auto height = replay->keyframe().height;
+    replace_room(new Room(std::move(replay)), width, height);
+}
+
+void Window::replace_room(Room *new_room, double width, double height) {
+    // the recording belongs to the old room
+    if (room->is_recording()) {
+        sim_controls->set_recording(false);
+        stop_recording();
+    }
+
+    if (width != 0 || height != 0) {
+        resize(width, height + 80);
     }
     room_rem_listeners();
+    redit_menu->select_obj(nullptr);
+    auto old = room;
 
     room = new_room;
-    room->setSceneRect(0, 0, width(), height() - 40 * 2);
+    room->setSceneRect(0, 0, this->width(), this->height() - 40 * 2);
     room->run_simulation(sim_controls->playing());
+    room->set_time_scale(sim_controls->time_scale());
+    room->set_rewind_budget(rewind_budget);
+    room->set_deterministic(deterministic);
+    room->set_sensing(sensing);
+    room->set_robot_sensing(robot_sensing);
+    room->set_input_log(input_log);
 
     room_listeners();
 
     room_view->setScene(room);
+    // also stops the simulation of the old room
+    old->deleteLater();
 }
 
-//---------------------------------------------------------------------------//
-//                                  PRIVATE                                  //
-//---------------------------------------------------------------------------//
+void Window::start_io() {
+    if (io.joinable()) {
+        io.join();
+    }
+    sim_controls->set_busy(true);
+}
+
+void Window::finish_io(function<void()> done) {
+    // called from the `io` thread, `done` runs on the GUI thread, `io` may
+    // already be other job if this one was joined by `start_io`
+    auto job = this_thread::get_id();
+    QMetaObject::invokeMethod(
+        this,
+        [this, done, job] {
+            if (io.get_id() == job) {
+                io.join();
+                sim_controls->set_busy(false);
+            }
+            done();
+        },
+        Qt::QueuedConnection
+    );
+}
+
+Progress Window::io_progress() {
+    return [this, last = -1](double done) mutable {
+        int percent = done * 100;
+        if (percent == last) {
+            return;
+        }
+        last = percent;
+        QMetaObject::invokeMethod(
+            this,
+            [this, percent] { sim_controls->show_progress(percent); },
+            Qt::QueuedConnection
+        );
+    };
+}
 
 void Window::room_listeners() {
     connect(
@@ -106,7 +371,20 @@ void Window::room_listeners() {
         room,
         &Room::run_simulation
     );
-    connect(sim_controls, &SimControls::save_room, room, &Room::save);
+    connect(
+        sim_controls,
+        &SimControls::change_time_scale,
+        room,
+        &Room::set_time_scale
+    );
+    connect(room, &Room::rate_change, sim_controls, &SimControls::show_rate);
+    connect(
+        room,
+        &Room::history_change,
+        sim_controls,
+        &SimControls::show_history
+    );
+    connect(sim_controls, &SimControls::seek, room, &Room::seek);
 
     connect(room, &Room::new_selection, redit_menu, &ReditMenu::select_obj);
     connect(redit_menu, &ReditMenu::remove_obj, room, &Room::remove_obj);
@@ -123,7 +401,25 @@ void Window::room_rem_listeners() {
         room,
         &Room::run_simulation
     );
-    disconnect(sim_controls, &SimControls::save_room, room, &Room::save);
+    disconnect(
+        sim_controls,
+        &SimControls::change_time_scale,
+        room,
+        &Room::set_time_scale
+    );
+    disconnect(
+        room,
+        &Room::rate_change,
+        sim_controls,
+        &SimControls::show_rate
+    );
+    disconnect(
+        room,
+        &Room::history_change,
+        sim_controls,
+        &SimControls::show_history
+    );
+    disconnect(sim_controls, &SimControls::seek, room, &Room::seek);
 
     disconnect(room, &Room::new_selection, redit_menu, &ReditMenu::select_obj);
     disconnect(redit_menu, &ReditMenu::remove_obj, room, &Room::remove_obj);
@@ -133,4 +429,26 @@ void Window::room_rem_listeners() {
     disconnect(menu, &Menu::add_robot, room, &Room::add_robot_slot);
 }
 
+void Window::update_profile() {
+    auto text = QString("%1 %2 %3 %4")
+        .arg("phase", -9)
+        .arg("min", 8)
+        .arg("avg", 8)
+        .arg("p99", 8);
+
+    auto profile = room->profile();
+    for (size_t i = 0; i < PHASE_COUNT; ++i) {
+        auto &s = profile[i];
+        text += QString("\n%1 %2 %3 %4")
+            .arg(phase_name(static_cast<Phase>(i)), -9)
+            .arg(s.min * 1e6, 8, 'f', 1)
+            .arg(s.avg * 1e6, 8, 'f', 1)
+            .arg(s.p99 * 1e6, 8, 'f', 1);
+    }
+    text += "\n(microseconds)";
+
+    profile_overlay->setText(text);
+    profile_overlay->adjustSize();
+}
+
 } // namespace icp
@@ -6,6 +6,13 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <QLabel>
 #include <QLayout>
 #include <QPushButton>
 #include <QPointer>
@@ -30,25 +37,92 @@ public:
      */
     explicit Window(QWidget *parent = nullptr);
 
+    /**
+     * @brief Waits for the room that is being loaded/saved.
+     */
+    ~Window() override;
+
+    /**
+     * @brief Sets the maximum memory taken by the history to which the room
+     * can be rewound (also for the rooms loaded later).
+     * @param bytes The memory budget in bytes.
+     */
+    void set_rewind_budget(std::size_t bytes);
+
+    /**
+     * @brief Sets deterministic mode of the simulation of the room (also for
+     * the rooms loaded later).
+     */
+    void set_deterministic(bool deterministic);
+
+    /**
+     * @brief Sets the algorithm used by the robots to find the closest
+     * obstacle (also for the rooms loaded later).
+     */
+    void set_sensing(Sensing sensing);
+
+    /**
+     * @brief Sets whether the robots see the other robots (also for the
+     * rooms loaded later).
+     */
+    void set_robot_sensing(bool sensing);
+
+    /**
+     * @brief Writes all the changes of the rooms to the input log, so that
+     * the simulation can be repeated by `icp-robots-sim`.
+     * @param filename Path to the input log.
+     * @throws std::runtime_error when the file cannot be created.
+     */
+    void set_input_log(const std::string &filename);
+
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void timerEvent(QTimerEvent *event) override;
 
 private slots:
     void show_menu();
+    void show_profile(bool show);
 
     void load(std::string filename);
+    void save(std::string filename);
+    void start_recording(std::string filename);
+    void stop_recording();
 
 private:
+    void show_room(World world);
+    void show_replay(std::unique_ptr<TrajectoryReader> replay);
+    void replace_room(Room *new_room, double width, double height);
+
+    void start_io();
+    void finish_io(std::function<void()> done);
+    Progress io_progress();
+
     void room_listeners();
 
     void room_rem_listeners();
 
+    void update_profile();
+
     QPointer<QPushButton> menu_button;
     QPointer<Menu> menu;
     QPointer<QGraphicsView> room_view;
     QPointer<Room> room;
     QPointer<SimControls> sim_controls;
     QPointer<ReditMenu> redit_menu;
+    // durations of the phases of the simulation over the room
+    QPointer<QLabel> profile_overlay;
+
+    // refreshes the overlay while it is shown
+    int profile_timer;
+    std::size_t rewind_budget;
+    bool deterministic;
+    Sensing sensing;
+    bool robot_sensing;
+    // shared by all the rooms, `nullptr` if the inputs are not logged
+    std::shared_ptr<InputLogWriter> input_log;
+
+    // loads or saves room so that the GUI doesn't freeze
+    std::thread io;
 };
 
 } // namespace icp
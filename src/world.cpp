@@ -0,0 +1,962 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Simulation of robots and obstacles independent of Qt. (source file)
+ */
+
+#include "world.hpp"
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include "collision.hpp"
+
+namespace icp {
+
+using namespace std;
+
+/**
+ * @brief Number of changed obstacles after which the grid of the obstacles
+ * (and the distance field) is rebuilt whole instead of updating it.
+ */
+constexpr size_t MAX_CELL_CHANGES = 64;
+
+/**
+ * @brief Gets the unit vector of the angle. Cosine and sine are computed by
+ * single call of `sincos` where it is available (GNU), it gives the same
+ * values as separate `cos` and `sin`.
+ */
+static Vec2 direction(double angle) {
+#if defined(__GLIBC__)
+    double s;
+    double c;
+    sincos(angle, &s, &c);
+    return Vec2{ c, s };
+#else
+    return Vec2{ cos(angle), sin(angle) };
+#endif
+}
+
+/**
+ * @brief Converts angle in radians to the angle in degrees as it is shown to
+ * the user (in range [-180, 180], counterclockwise).
+ */
+static double user_angle(double angle) {
+    auto ang = -angle / M_PI * 180;
+    auto sign = ang > 0 ? 1 : -1;
+    ang = abs(ang);
+    auto rnum = (int)ang % 360;
+    ang = sign * (rnum + (ang - (int)ang));
+    if (ang < -180) {
+        ang += 360;
+    }
+    return ang;
+}
+
+/**
+ * @brief Writes the room in the format of the room file.
+ */
+static void save_room(
+    Sink &sink,
+    double width,
+    double height,
+    const vector<ObstacleState> &obstacles,
+    const RobotArrays &robots,
+    const Progress &progress
+) {
+    double total = obstacles.size() + robots.size();
+    auto report = [&](size_t done) {
+        if (progress && done % PROGRESS_STEP == 0) {
+            progress(done / total);
+        }
+    };
+
+    TextWriter out(sink);
+    out << "room: " << width << 'x' << height << '\n';
+    for (size_t i = 0; i < obstacles.size(); ++i) {
+        auto &o = obstacles[i];
+        out << "obstacle: " << o.hitbox.w << 'x' << o.hitbox.h << " ["
+            << o.hitbox.x << ", " << o.hitbox.y << "]\n";
+        report(i);
+    }
+
+    for (size_t i = 0; i < robots.size(); ++i) {
+        robots.get(i).save(out);
+        report(obstacles.size() + i);
+    }
+
+    out.flush();
+    if (progress) {
+        progress(1);
+    }
+}
+
+//---------------------------------------------------------------------------//
+//                                RobotState                                 //
+//---------------------------------------------------------------------------//
+
+RobotState RobotState::dummy(Vec2 position, double angle, double speed) {
+    RobotState res;
+    res.kind = RobotKind::Dummy;
+    res.hitbox = Rect{
+        position.x, position.y, ROBOT_DIAMETER, ROBOT_DIAMETER
+    };
+    res.set_angle(angle);
+    res.mspeed = speed;
+    return res;
+}
+
+RobotState RobotState::automatic(
+    Vec2 position,
+    double angle,
+    double speed,
+    double elide_dist,
+    double elide_rot,
+    double rot_speed
+) {
+    auto res = dummy(position, angle, speed);
+    res.kind = RobotKind::Auto;
+    res.sspeed = speed;
+    res.elide_dist = elide_dist;
+    res.elide_rot = elide_rot;
+    res.rot_speed = rot_speed;
+    return res;
+}
+
+RobotState RobotState::controlled(
+    Vec2 position,
+    double angle,
+    double speed,
+    double rot_speed
+) {
+    auto res = dummy(position, angle, 0);
+    res.kind = RobotKind::Control;
+    res.sspeed = speed;
+    res.rot_speed = rot_speed;
+    return res;
+}
+
+void RobotState::set_angle(double angle) {
+    this->angle = angle;
+    dir = direction(angle);
+}
+
+double RobotState::speed() const {
+    switch (kind) {
+        case RobotKind::Auto:
+            return rot_remain != 0 ? sspeed : mspeed;
+        case RobotKind::Control:
+            return cur_speed == 0 ? sspeed : mspeed;
+        default:
+            return mspeed;
+    }
+}
+
+void RobotState::set_speed(double speed) {
+    switch (kind) {
+        case RobotKind::Auto:
+            if (rot_remain != 0) {
+                sspeed = speed;
+            } else {
+                mspeed = speed;
+            }
+            break;
+        case RobotKind::Control:
+            if (cur_speed == 0) {
+                sspeed = speed;
+            }
+            mspeed = speed;
+            break;
+        default:
+            mspeed = speed;
+            break;
+    }
+}
+
+void RobotState::save(TextWriter &out) const {
+    switch (kind) {
+        case RobotKind::Dummy:
+            out << "robot: [" << hitbox.x << ", " << hitbox.y
+                << "] { speed: " << mspeed << ", angle: "
+                << user_angle(angle);
+            break;
+        case RobotKind::Auto:
+            out << "auto_robot: [" << hitbox.x << ", " << hitbox.y
+                << "] { speed: " << speed() << ", rotation_speed: "
+                << rot_speed / M_PI * 180 << ", elide_distance: "
+                << elide_dist << ", elide_rotation: "
+                << elide_rot / M_PI * 180 << ", angle: "
+                << user_angle(angle);
+            break;
+        case RobotKind::Control:
+            out << "control_robot: [" << hitbox.x << ", " << hitbox.y
+                << "] { speed: " << speed() << ", rotation_speed: "
+                << rot_speed / M_PI * 180 << ", angle: " << user_angle(angle);
+            break;
+    }
+
+    if (lidar_rays) {
+        out << ", lidar_rays: " << double(lidar_rays) << ", lidar_angle: "
+            << lidar_fov / M_PI * 180;
+    }
+    out << " }\n";
+}
+
+//---------------------------------------------------------------------------//
+//                                RobotArrays                                //
+//---------------------------------------------------------------------------//
+
+void RobotArrays::push(const RobotState &robot) {
+    kind.push_back(robot.kind);
+    x.push_back(robot.hitbox.x);
+    y.push_back(robot.hitbox.y);
+    radius.push_back(robot.hitbox.w / 2);
+    angle.push_back(robot.angle);
+    dir_x.push_back(robot.dir.x);
+    dir_y.push_back(robot.dir.y);
+    mspeed.push_back(robot.mspeed);
+    sspeed.push_back(robot.sspeed);
+    rot_speed.push_back(robot.rot_speed);
+    rot_remain.push_back(robot.rot_remain);
+    elide_dist.push_back(robot.elide_dist);
+    elide_rot.push_back(robot.elide_rot);
+    cur_speed.push_back(robot.cur_speed);
+    cur_rot_speed.push_back(robot.cur_rot_speed);
+    lidar_fov.push_back(robot.lidar_fov);
+    lidar_rays.push_back(robot.lidar_rays);
+    grabbed.push_back(robot.grabbed);
+}
+
+RobotState RobotArrays::get(size_t idx) const {
+    RobotState res;
+    res.kind = kind[idx];
+    res.hitbox = hitbox(idx);
+    res.angle = angle[idx];
+    res.dir = Vec2{ dir_x[idx], dir_y[idx] };
+    res.mspeed = mspeed[idx];
+    res.sspeed = sspeed[idx];
+    res.rot_speed = rot_speed[idx];
+    res.rot_remain = rot_remain[idx];
+    res.elide_dist = elide_dist[idx];
+    res.elide_rot = elide_rot[idx];
+    res.cur_speed = cur_speed[idx];
+    res.cur_rot_speed = cur_rot_speed[idx];
+    res.lidar_fov = lidar_fov[idx];
+    res.lidar_rays = lidar_rays[idx];
+    res.grabbed = grabbed[idx];
+    return res;
+}
+
+void RobotArrays::set(size_t idx, const RobotState &robot) {
+    kind[idx] = robot.kind;
+    x[idx] = robot.hitbox.x;
+    y[idx] = robot.hitbox.y;
+    radius[idx] = robot.hitbox.w / 2;
+    angle[idx] = robot.angle;
+    dir_x[idx] = robot.dir.x;
+    dir_y[idx] = robot.dir.y;
+    mspeed[idx] = robot.mspeed;
+    sspeed[idx] = robot.sspeed;
+    rot_speed[idx] = robot.rot_speed;
+    rot_remain[idx] = robot.rot_remain;
+    elide_dist[idx] = robot.elide_dist;
+    elide_rot[idx] = robot.elide_rot;
+    cur_speed[idx] = robot.cur_speed;
+    cur_rot_speed[idx] = robot.cur_rot_speed;
+    lidar_fov[idx] = robot.lidar_fov;
+    lidar_rays[idx] = robot.lidar_rays;
+    grabbed[idx] = robot.grabbed;
+}
+
+void RobotArrays::swap_remove(size_t idx) {
+    for_each_array([=](auto &arr) {
+        arr[idx] = arr.back();
+        arr.pop_back();
+    });
+}
+
+void RobotArrays::update_directions(const uint32_t *idxs, size_t count) {
+    // the angle is read once, the stores to `dir_x` could alias it
+    for (size_t k = 0; k < count; ++k) {
+        auto i = idxs[k];
+        auto d = direction(angle[i]);
+        dir_x[i] = d.x;
+        dir_y[i] = d.y;
+    }
+}
+
+void RobotArrays::update_directions() {
+    dir_x.resize(size());
+    dir_y.resize(size());
+    for (size_t i = 0; i < size(); ++i) {
+        auto d = direction(angle[i]);
+        dir_x[i] = d.x;
+        dir_y[i] = d.y;
+    }
+}
+
+void RobotArrays::erase(size_t idx) {
+    for_each_array([=](auto &arr) { arr.erase(arr.begin() + idx); });
+}
+
+size_t RobotArrays::robot_size() {
+    size_t res = 0;
+    RobotArrays().for_each_array([&](auto &arr) {
+        res += sizeof(typename decay_t<decltype(arr)>::value_type);
+    });
+    return res;
+}
+
+size_t RobotArrays::saved_robot_size() {
+    size_t res = 0;
+    RobotArrays().for_each_saved_array([&](auto &arr) {
+        res += sizeof(typename decay_t<decltype(arr)>::value_type);
+    });
+    return res;
+}
+
+//---------------------------------------------------------------------------//
+//                                WorldState                                 //
+//---------------------------------------------------------------------------//
+
+void WorldState::save(ostream &out, const Progress &progress) const {
+    StreamSink sink(out);
+    save(sink, progress);
+}
+
+void WorldState::save(Sink &sink, const Progress &progress) const {
+    save_room(sink, width, height, obstacles, robots, progress);
+}
+
+//---------------------------------------------------------------------------//
+//                                  PUBLIC                                   //
+//---------------------------------------------------------------------------//
+
+World::World(double width, double height) :
+    mobstacles(),
+    mrobots(),
+    mwidth(width),
+    mheight(height),
+    mticks(0),
+    mbroadphase(Broadphase::Grid),
+    grid(ROBOT_DIAMETER),
+    mdeterministic(false),
+    turned(),
+    pairs(),
+    push_x(),
+    push_y(),
+    tree(),
+    tree_dirty(false),
+    candidates(),
+    msensing(Sensing::Tree),
+    cells(),
+    field(),
+    cells_dirty(true),
+    cell_changes(),
+    mrobot_sensing(true),
+    lidar_first(),
+    lidar_dists(),
+    lidar_offsets(),
+    offsets_rays(0),
+    offsets_fov(0),
+    lidar_dirs(),
+    mprofiler()
+{}
+
+void World::set_size(double width, double height) {
+    mwidth = width;
+    mheight = height;
+    cells_dirty = true;
+}
+
+size_t World::add_robot(RobotState robot) {
+    mrobots.push(robot);
+    return mrobots.size() - 1;
+}
+
+size_t World::add_obstacle(ObstacleState obstacle) {
+    mobstacles.push_back(obstacle);
+    obstacle_changed(obstacle, true);
+    return mobstacles.size() - 1;
+}
+
+void World::remove_robot(size_t idx) {
+    if (mdeterministic) {
+        mrobots.erase(idx);
+    } else {
+        mrobots.swap_remove(idx);
+    }
+}
+
+void World::remove_obstacle(size_t idx) {
+    obstacle_changed(mobstacles[idx], false);
+    if (mdeterministic) {
+        mobstacles.erase(mobstacles.begin() + idx);
+    } else {
+        swap(mobstacles[idx], mobstacles.back());
+        mobstacles.pop_back();
+    }
+}
+
+void World::set_robot(size_t idx, const RobotState &robot) {
+    mrobots.set(idx, robot);
+}
+
+void World::move_robot(size_t idx, Vec2 position) {
+    mrobots.x[idx] = position.x;
+    mrobots.y[idx] = position.y;
+}
+
+void World::set_robot_speed(size_t idx, double speed) {
+    auto robot = mrobots.get(idx);
+    robot.set_speed(speed);
+    mrobots.mspeed[idx] = robot.mspeed;
+    mrobots.sspeed[idx] = robot.sspeed;
+}
+
+void World::set_robot_angle(size_t idx, double angle) {
+    mrobots.angle[idx] = angle;
+    auto d = direction(angle);
+    mrobots.dir_x[idx] = d.x;
+    mrobots.dir_y[idx] = d.y;
+}
+
+void World::set_robot_grabbed(size_t idx, bool grabbed) {
+    mrobots.grabbed[idx] = grabbed;
+}
+
+void World::set_robot_params(size_t idx, const RobotState &robot) {
+    mrobots.rot_speed[idx] = robot.rot_speed;
+    mrobots.elide_dist[idx] = robot.elide_dist;
+    mrobots.elide_rot[idx] = robot.elide_rot;
+    mrobots.cur_speed[idx] = robot.cur_speed;
+    mrobots.cur_rot_speed[idx] = robot.cur_rot_speed;
+}
+
+void World::set_obstacle(size_t idx, ObstacleState obstacle) {
+    obstacle_changed(mobstacles[idx], false);
+    obstacle_changed(obstacle, true);
+    mobstacles[idx] = obstacle;
+}
+
+void World::tick(double delta) {
+    update_obstacles();
+
+    auto t = Profiler::now();
+    move_robots(delta);
+    mprofiler.lap(Phase::Move, t);
+
+    // collisions of robots with the border of the room
+    for (size_t i = 0; i < mrobots.size(); ++i) {
+        if (!mrobots.grabbed[i]) {
+            border_collision(i);
+        }
+    }
+    mprofiler.lap(Phase::Border, t);
+
+    obstacle_collisions();
+    mprofiler.lap(Phase::Obstacles, t);
+    robot_collisions();
+    mprofiler.lap(Phase::Robots, t);
+    ++mticks;
+}
+
+WorldState World::state() const {
+    WorldState res;
+    res.width = mwidth;
+    res.height = mheight;
+    res.ticks = mticks;
+    res.obstacles = mobstacles;
+    res.robots = mrobots;
+    return res;
+}
+
+void World::restore(const WorldState &state) {
+    mwidth = state.width;
+    mheight = state.height;
+    mticks = state.ticks;
+    mobstacles = state.obstacles;
+    mrobots = state.robots;
+    mrobots.update_directions();
+    tree_dirty = true;
+    cells_dirty = true;
+}
+
+void World::save(ostream &out, const Progress &progress) const {
+    StreamSink sink(out);
+    save(sink, progress);
+}
+
+void World::save(Sink &sink, const Progress &progress) const {
+    save_room(sink, mwidth, mheight, mobstacles, mrobots, progress);
+}
+
+void World::set_broadphase(Broadphase broadphase) {
+    mbroadphase = broadphase;
+}
+
+void World::set_deterministic(bool deterministic) {
+    mdeterministic = deterministic;
+}
+
+void World::set_sensing(Sensing sensing) {
+    msensing = sensing;
+    // the grid isn't updated while it isn't used
+    cells_dirty = true;
+    cell_changes.clear();
+}
+
+void World::set_robot_sensing(bool sensing) {
+    mrobot_sensing = sensing;
+}
+
+LidarScan World::lidar(size_t idx) const {
+    if (idx + 1 >= lidar_first.size()) {
+        return LidarScan{};
+    }
+    auto first = lidar_first[idx];
+    return LidarScan{
+        lidar_dists.data() + first, lidar_first[idx + 1] - first
+    };
+}
+
+//---------------------------------------------------------------------------//
+//                                 PRIVATE                                   //
+//---------------------------------------------------------------------------//
+
+void World::move_robots(double delta) {
+    auto &r = mrobots;
+    // the robots see each other at the positions from the start of the tick
+    if (mrobot_sensing && mbroadphase == Broadphase::Grid) {
+        grid.build(mrobots, mwidth, mheight);
+    }
+    cast_lidars();
+
+    // the robots may stop or rotate based on what they see, the directions
+    // of the rotated robots are updated after all of them have seen
+    turned.clear();
+    for (size_t i = 0; i < r.size(); ++i) {
+        if (!r.grabbed[i] && r.kind[i] != RobotKind::Dummy) {
+            steer_robot(i, delta, obstacle_distance(i), lidar(i));
+        }
+    }
+    r.update_directions(turned.data(), turned.size());
+
+    // move all the robots in their direction at once
+    auto x = r.x.data();
+    auto y = r.y.data();
+    auto dir_x = r.dir_x.data();
+    auto dir_y = r.dir_y.data();
+    auto mspeed = r.mspeed.data();
+    auto grabbed = r.grabbed.data();
+    for (size_t i = 0; i < r.size(); ++i) {
+        auto speed = grabbed[i] ? 0 : mspeed[i];
+        x[i] += dir_x[i] * speed * delta;
+        y[i] += dir_y[i] * speed * delta;
+    }
+}
+
+void World::steer_robot(
+    size_t idx,
+    double delta,
+    double distance,
+    LidarScan scan
+) {
+    auto &r = mrobots;
+    auto &mspeed = r.mspeed[idx];
+    auto &sspeed = r.sspeed[idx];
+    auto &angle = r.angle[idx];
+
+    switch (r.kind[idx]) {
+        case RobotKind::Dummy:
+            break;
+        case RobotKind::Auto: {
+            auto &rot_remain = r.rot_remain[idx];
+            if (rot_remain == 0 && distance <= r.elide_dist[idx]) {
+                rot_remain = r.elide_rot[idx];
+                sspeed = mspeed;
+                mspeed = 0;
+
+                // with lidar rotate to the side with more free space
+                double left = 0;
+                double right = 0;
+                for (size_t k = 0; k < scan.count / 2; ++k) {
+                    left += scan.dists[k];
+                    right += scan.dists[scan.count - k - 1];
+                }
+                if (left != right) {
+                    rot_remain = left > right
+                        ? -abs(rot_remain) : abs(rot_remain);
+                }
+            }
+
+            if (rot_remain != 0) {
+                auto ang = r.rot_speed[idx] * delta;
+                ang = rot_remain < 0 ? -ang : ang;
+                if (abs(rot_remain) < abs(ang)) {
+                    ang = rot_remain;
+                    rot_remain = 0;
+                } else {
+                    rot_remain -= ang;
+                }
+
+                angle += ang;
+                turned.push_back(idx);
+
+                if (rot_remain == 0) {
+                    mspeed = sspeed;
+                }
+            }
+            break;
+        }
+        case RobotKind::Control:
+            if (distance == 0) {
+                sspeed = mspeed;
+                mspeed = 0;
+            } else {
+                mspeed = r.cur_speed[idx];
+            }
+
+            if (r.cur_rot_speed[idx] != 0) {
+                angle += r.cur_rot_speed[idx] * delta;
+                turned.push_back(idx);
+            }
+            break;
+    }
+}
+
+void World::obstacle_collisions() {
+    for (size_t i = 0; i < mrobots.size(); ++i) {
+        if (mrobots.grabbed[i]) {
+            continue;
+        }
+
+        // Resolve the collisions in the order of the obstacles as if all of
+        // them were checked. When the robot moves, it may now overlap
+        // obstacles that were not candidates, so query again.
+        auto box = mrobots.hitbox(i);
+        uint32_t next = 0;
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            candidates.clear();
+            tree.query(box, [&](uint32_t idx) {
+                if (idx >= next) {
+                    candidates.push_back(idx);
+                }
+            });
+            sort(candidates.begin(), candidates.end());
+
+            for (auto idx : candidates) {
+                auto pos = box.top_left();
+                obstacle_collision(box, mobstacles[idx].hitbox);
+                if (pos.x != box.x || pos.y != box.y) {
+                    next = idx + 1;
+                    moved = true;
+                    break;
+                }
+            }
+        }
+        mrobots.x[i] = box.x;
+        mrobots.y[i] = box.y;
+    }
+}
+
+template<typename F> void World::for_each_robot_pair(F &&f) {
+    for (size_t i = 0; i < mrobots.size(); ++i) {
+        if (mrobots.grabbed[i]) {
+            continue;
+        }
+        for (size_t j = i + 1; j < mrobots.size(); ++j) {
+            if (!mrobots.grabbed[j]) {
+                f(i, j);
+            }
+        }
+    }
+}
+
+void World::robot_collisions() {
+    if (mdeterministic) {
+        deterministic_robot_collisions();
+        return;
+    }
+
+    auto &x = mrobots.x;
+    auto &y = mrobots.y;
+    auto robot_pair = [&](size_t i, size_t j) {
+        Vec2 a{ x[i], y[i] };
+        Vec2 b{ x[j], y[j] };
+        if (robot_collision(a, mrobots.radius[i], b, mrobots.radius[j])) {
+            x[i] = a.x;
+            y[i] = a.y;
+            x[j] = b.x;
+            y[j] = b.y;
+        }
+    };
+
+    if (mbroadphase == Broadphase::Grid) {
+        grid.build(mrobots, mwidth, mheight);
+        grid.for_each_pair(robot_pair);
+        return;
+    }
+
+    for_each_robot_pair(robot_pair);
+}
+
+void World::deterministic_robot_collisions() {
+    auto &x = mrobots.x;
+    auto &y = mrobots.y;
+    push_x.assign(mrobots.size(), 0);
+    push_y.assign(mrobots.size(), 0);
+
+    // the positions are not changed until all the pushes are known
+    auto robot_pair = [&](size_t i, size_t j) {
+        Vec2 push;
+        if (robot_push(
+            { x[i], y[i] },
+            mrobots.radius[i],
+            { x[j], y[j] },
+            mrobots.radius[j],
+            push
+        )) {
+            push_x[i] -= push.x;
+            push_y[i] -= push.y;
+            push_x[j] += push.x;
+            push_y[j] += push.y;
+        }
+    };
+
+    if (mbroadphase == Broadphase::Grid) {
+        // the same order as the brute force, independent of the cells
+        grid.build(mrobots, mwidth, mheight);
+        pairs.clear();
+        grid.for_each_pair([&](uint64_t i, uint64_t j) {
+            pairs.push_back(i << 32 | j);
+        });
+        sort(pairs.begin(), pairs.end());
+        for (auto p : pairs) {
+            robot_pair(p >> 32, p & UINT32_MAX);
+        }
+    } else {
+        for_each_robot_pair(robot_pair);
+    }
+
+    for (size_t i = 0; i < mrobots.size(); ++i) {
+        x[i] += push_x[i];
+        y[i] += push_y[i];
+    }
+}
+
+void World::border_collision(size_t idx) {
+    auto &x = mrobots.x[idx];
+    auto &y = mrobots.y[idx];
+    auto size = 2 * mrobots.radius[idx];
+
+    if (x < 0) {
+        x = 0;
+    } else if (x + size > mwidth) {
+        x = mwidth - size;
+    }
+
+    if (y < 0) {
+        y = 0;
+    } else if (y + size > mheight) {
+        y = mheight - size;
+    }
+}
+
+double World::obstacle_distance(size_t idx) {
+    auto r = mrobots.radius[idx];
+    Vec2 c{ mrobots.x[idx] + r, mrobots.y[idx] + r };
+    Vec2 d{ mrobots.dir_x[idx], mrobots.dir_y[idx] };
+
+    double res = rect_distance(c, d, Rect{ 0, 0, mwidth, mheight });
+    switch (msensing) {
+    case Sensing::Tree:
+        res = tree.ray_distance(c, d, res);
+        break;
+    case Sensing::Grid:
+        res = cells.ray_distance(tree, c, d, res);
+        break;
+    case Sensing::DistanceField:
+        res = field.ray_distance(cells, tree, c, d, res);
+        break;
+    }
+
+    // robots farther than the distance to which the robot reacts don't
+    // change its steering, so they are not searched for
+    auto reach = r;
+    switch (mrobots.kind[idx]) {
+        case RobotKind::Auto:
+            reach = mrobots.rot_remain[idx] != 0
+                ? -INFINITY : r + mrobots.elide_dist[idx];
+            break;
+        case RobotKind::Control:
+            break;
+        default:
+            reach = -INFINITY;
+            break;
+    }
+    auto far = min(res, reach);
+    if (far > 0) {
+        auto near = robot_distance(idx, c, d, far);
+        if (near < far) {
+            res = near;
+        }
+    }
+
+    return max(res - r, 0.);
+}
+
+double World::robot_distance(size_t idx, Vec2 p, Vec2 d, double max) const {
+    if (!mrobot_sensing) {
+        return max;
+    }
+    if (mbroadphase == Broadphase::Grid) {
+        return grid.ray_distance(mrobots, idx, p, d, max);
+    }
+
+    auto res = max;
+    for (size_t i = 0; i < mrobots.size(); ++i) {
+        if (i == idx || mrobots.grabbed[i]) {
+            continue;
+        }
+        auto r = mrobots.radius[i];
+        Vec2 c{ mrobots.x[i] + r, mrobots.y[i] + r };
+        res = min(res, circle_distance(p, d, c, r));
+    }
+    return res;
+}
+
+void World::cast_lidars() {
+    auto &r = mrobots;
+    lidar_first.resize(r.size() + 1);
+    size_t total = 0;
+    for (size_t i = 0; i < r.size(); ++i) {
+        lidar_first[i] = total;
+        total += r.grabbed[i] ? 0 : r.lidar_rays[i];
+    }
+    lidar_first[r.size()] = total;
+    lidar_dists.resize(total);
+
+    Rect room{ 0, 0, mwidth, mheight };
+    for (size_t i = 0; i < r.size(); ++i) {
+        auto first = lidar_first[i];
+        auto count = lidar_first[i + 1] - first;
+        if (count == 0) {
+            continue;
+        }
+
+        // the robots usually have the same lidars, so the relative
+        // directions are computed only when they differ
+        if (count != offsets_rays || r.lidar_fov[i] != offsets_fov) {
+            lidar_directions(count, r.lidar_fov[i]);
+        }
+
+        auto rad = r.radius[i];
+        Vec2 c{ r.x[i] + rad, r.y[i] + rad };
+        Vec2 o{ r.dir_x[i], r.dir_y[i] };
+        auto dists = lidar_dists.data() + first;
+        lidar_dirs.resize(count);
+        for (size_t k = 0; k < count; ++k) {
+            // rotate the relative direction by the orientation
+            auto &a = lidar_offsets[k];
+            lidar_dirs[k] = Vec2{
+                o.x * a.x - o.y * a.y,
+                o.x * a.y + o.y * a.x,
+            };
+            dists[k] = rect_distance(c, lidar_dirs[k], room);
+        }
+
+        switch (msensing) {
+        case Sensing::Tree:
+            tree.ray_distances(c, lidar_dirs.data(), dists, count);
+            break;
+        case Sensing::Grid:
+            for (size_t k = 0; k < count; ++k) {
+                dists[k] = cells.ray_distance(tree, c, lidar_dirs[k], dists[k]);
+            }
+            break;
+        case Sensing::DistanceField:
+            for (size_t k = 0; k < count; ++k) {
+                dists[k] = field.ray_distance(
+                    cells, tree, c, lidar_dirs[k], dists[k]
+                );
+            }
+            break;
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+            dists[k] = robot_distance(i, c, lidar_dirs[k], dists[k]);
+            dists[k] = max(dists[k] - rad, 0.);
+        }
+    }
+}
+
+void World::lidar_directions(uint32_t rays, double fov) {
+    offsets_rays = rays;
+    offsets_fov = fov;
+    lidar_offsets.resize(rays);
+    if (rays == 1) {
+        lidar_offsets[0] = Vec2{ 1, 0 };
+        return;
+    }
+    for (uint32_t k = 0; k < rays; ++k) {
+        auto a = -fov / 2 + fov * k / (rays - 1);
+        lidar_offsets[k] = Vec2{ cos(a), sin(a) };
+    }
+}
+
+void World::obstacle_changed(const ObstacleState &obstacle, bool added) {
+    tree_dirty = true;
+    // grabbed obstacles are not in the grid
+    if (msensing == Sensing::Tree || cells_dirty || obstacle.grabbed) {
+        return;
+    }
+
+    // rebuilding is faster than many updates
+    if (cell_changes.size() >= MAX_CELL_CHANGES) {
+        cells_dirty = true;
+        cell_changes.clear();
+    } else {
+        cell_changes.push_back(CellChange{ obstacle.hitbox, added });
+    }
+}
+
+void World::update_obstacles() {
+    if (tree_dirty) {
+        tree.build(mobstacles);
+        tree_dirty = false;
+    }
+
+    if (msensing == Sensing::Tree) {
+        return;
+    }
+
+    auto use_field = msensing == Sensing::DistanceField;
+    if (cells_dirty) {
+        cells.build(mobstacles, mwidth, mheight);
+        if (use_field) {
+            field.build(cells);
+        }
+        cells_dirty = false;
+    } else {
+        for (auto &c : cell_changes) {
+            if (c.added) {
+                cells.add(c.hitbox);
+            } else {
+                cells.remove(c.hitbox);
+            }
+            if (use_field) {
+                field.changed(cells, c.hitbox);
+            }
+        }
+        if (use_field) {
+            field.update(cells);
+        }
+    }
+    cell_changes.clear();
+}
+
+} // namespace icp
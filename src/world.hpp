@@ -0,0 +1,749 @@
+/**
+ * @file
+ * @authors Martin Slezák (xsleza26), Jakub Antonín Štigler (xstigl00)
+ * @brief Simulation of robots and obstacles independent of Qt. (header file)
+ */
+
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+#include "distance_field.hpp"
+#include "obstacle_grid.hpp"
+#include "geometry.hpp"
+#include "obstacle_tree.hpp"
+#include "profiler.hpp"
+#include "robot_grid.hpp"
+#include "text_writer.hpp"
+
+namespace icp {
+
+/**
+ * @brief How often should the robots update their position.
+ */
+constexpr std::chrono::milliseconds TICK_LEN = std::chrono::milliseconds(10);
+/**
+ * @brief How often should the robots update their position. (in seconds)
+ */
+constexpr double TICK_DELTA = TICK_LEN.count()
+    * decltype(TICK_LEN)::period::num
+    / static_cast<double>(decltype(TICK_LEN)::period::den);
+
+/**
+ * @brief Reports progress of long operation (such as loading or saving).
+ * The argument is the done part of the work in range [0, 1].
+ */
+using Progress = std::function<void(double done)>;
+
+/**
+ * @brief Number of objects processed between two reports of `Progress`.
+ */
+constexpr std::size_t PROGRESS_STEP = 4096;
+
+/**
+ * @brief Diameter of the hitbox of a robot (including its border).
+ */
+constexpr double ROBOT_DIAMETER = 56;
+
+/**
+ * @brief The largest number of rays of the lidar of a robot.
+ */
+constexpr std::uint32_t MAX_LIDAR_RAYS = 1024;
+
+/**
+ * @brief Determines how the robot behaves.
+ */
+enum class RobotKind {
+    /** @brief Robot that just goes forward. */
+    Dummy,
+    /** @brief Robot with basic AI. */
+    Auto,
+    /** @brief Robot controlled by the user. */
+    Control,
+};
+
+/**
+ * @brief State of a single robot in the simulation.
+ */
+struct RobotState {
+    /**
+     * @brief Creates state of a robot that just goes forward.
+     * @param position Top-left corner of the hitbox.
+     * @param angle Orientation of the robot (radians).
+     * @param speed Movement speed of the robot (pixels per second).
+     */
+    static RobotState dummy(Vec2 position, double angle, double speed);
+
+    /**
+     * @brief Creates state of a robot with basic AI.
+     * @param position Top-left corner of the hitbox.
+     * @param angle Orientation of the robot (radians).
+     * @param speed Movement speed of the robot (pixels per second).
+     * @param elide_dist How far from obstacle the robot stops and starts to
+     * rotate.
+     * @param elide_rot How much the robot rotates when it detects obstacle.
+     * @param rot_speed How fast the robot rotates (radians per second).
+     */
+    static RobotState automatic(
+        Vec2 position,
+        double angle,
+        double speed,
+        double elide_dist = 20,
+        double elide_rot = M_PI / M_E,
+        double rot_speed = M_PI / 4
+    );
+
+    /**
+     * @brief Creates state of a robot controlled by the user.
+     * @param position Top-left corner of the hitbox.
+     * @param angle Orientation of the robot (radians).
+     * @param speed Movement speed of the robot (pixels per second).
+     * @param rot_speed How fast the robot rotates (radians per second).
+     */
+    static RobotState controlled(
+        Vec2 position,
+        double angle,
+        double speed,
+        double rot_speed = M_PI / 4
+    );
+
+    /**
+     * @brief Gets the unit vector of the orientation. It is not computed, it
+     * is kept with the angle.
+     */
+    Vec2 orientation_vec() const { return dir; }
+
+    /**
+     * @brief Sets the orientation and its unit vector.
+     * @param angle Orientation of the robot (radians).
+     */
+    void set_angle(double angle);
+
+    /**
+     * @brief Gets the movement speed as set by the user (doesn't change when
+     * the robot temporarily stops).
+     */
+    double speed() const;
+
+    /**
+     * @brief Sets the movement speed as set by the user.
+     */
+    void set_speed(double speed);
+
+    /**
+     * @brief Saves the robot in the format of the room file.
+     * @param out Writer to write the robot to.
+     */
+    void save(TextWriter &out) const;
+
+    RobotKind kind;
+    /** @brief Hitbox of the robot (the width and height are the same). */
+    Rect hitbox;
+    /**
+     * @brief Orientation of the robot in radians. Set it with `set_angle` so
+     * that `dir` is updated too.
+     */
+    double angle;
+    /** @brief Unit vector of the orientation (cosine and sine of `angle`). */
+    Vec2 dir;
+    /** @brief Current movement speed in pixels per second. */
+    double mspeed;
+    /** @brief Stored speed while the robot is stopped. */
+    double sspeed = 0;
+    /** @brief Rotation speed in radians per second. */
+    double rot_speed = 0;
+
+    /** @brief Remaining rotation of `Auto` robot. */
+    double rot_remain = 0;
+    /** @brief Distance at which `Auto` robot starts to rotate. */
+    double elide_dist = 0;
+    /** @brief How much `Auto` robot rotates when it detects obstacle. */
+    double elide_rot = 0;
+
+    /** @brief Current movement speed of `Control` robot. */
+    double cur_speed = 0;
+    /** @brief Current rotation speed of `Control` robot. */
+    double cur_rot_speed = 0;
+
+    /**
+     * @brief Angle covered by the rays of the lidar in radians, centered on
+     * the orientation of the robot.
+     */
+    double lidar_fov = M_PI;
+    /** @brief Number of the rays of the lidar, 0 if the robot has none. */
+    std::uint32_t lidar_rays = 0;
+
+    /** @brief The robot is held by the user and doesn't simulate. */
+    bool grabbed = false;
+};
+
+/**
+ * @brief State of a single obstacle in the simulation.
+ */
+struct ObstacleState {
+    /** @brief Hitbox of the obstacle. */
+    Rect hitbox;
+    /** @brief The obstacle is held by the user and doesn't collide. */
+    bool grabbed = false;
+};
+
+/**
+ * @brief States of all the robots in the simulation stored as structure of
+ * arrays, so that loops over all the robots touch only the data they use.
+ * Each array has one item per robot; the meaning of the items is the same as
+ * of the fields of `RobotState`.
+ */
+struct RobotArrays {
+    /**
+     * @brief Gets the number of robots.
+     */
+    std::size_t size() const { return kind.size(); }
+
+    /**
+     * @brief Adds robot to the end of the arrays.
+     */
+    void push(const RobotState &robot);
+
+    /**
+     * @brief Gets the state of the robot at the given index.
+     */
+    RobotState get(std::size_t idx) const;
+
+    /**
+     * @brief Sets the state of the robot at the given index.
+     */
+    void set(std::size_t idx, const RobotState &robot);
+
+    /**
+     * @brief Removes robot. The last robot is moved to its index.
+     */
+    void swap_remove(std::size_t idx);
+
+    /**
+     * @brief Recomputes `dir_x` and `dir_y` from `angle` for the given robots
+     * in a single pass.
+     * @param idxs Indexes of the robots whose angle changed.
+     * @param count Number of the indexes.
+     */
+    void update_directions(const std::uint32_t *idxs, std::size_t count);
+
+    /**
+     * @brief Recomputes `dir_x` and `dir_y` from `angle` for all the robots
+     * (e.g. after only the saved arrays were loaded).
+     */
+    void update_directions();
+
+    /**
+     * @brief Removes robot. The robots after it are moved one index back, so
+     * the order of the other robots doesn't change.
+     */
+    void erase(std::size_t idx);
+
+    /**
+     * @brief Gets the number of bytes of all the arrays of a single robot.
+     */
+    static std::size_t robot_size();
+
+    /**
+     * @brief Gets the number of bytes of the saved arrays of a single robot
+     * (see `for_each_saved_array`).
+     */
+    static std::size_t saved_robot_size();
+
+    /**
+     * @brief Gets the hitbox of the robot at the given index.
+     */
+    Rect hitbox(std::size_t idx) const {
+        return Rect{ x[idx], y[idx], 2 * radius[idx], 2 * radius[idx] };
+    }
+
+    /**
+     * @brief Calls `f(array)` for each of the arrays in the order in which
+     * they are declared.
+     */
+    template<typename F> void for_each_array(F f) {
+        each_array(*this, f, true);
+    }
+
+    /**
+     * @brief Calls `f(array)` for each of the arrays in the order in which
+     * they are declared.
+     */
+    template<typename F> void for_each_array(F f) const {
+        each_array(*this, f, true);
+    }
+
+    /**
+     * @brief Calls `f(array)` for each of the arrays that are saved (e.g. to
+     * the state file). `dir_x` and `dir_y` are skipped, they are computed
+     * from `angle` by `update_directions`.
+     */
+    template<typename F> void for_each_saved_array(F f) {
+        each_array(*this, f, false);
+    }
+
+    /**
+     * @brief Calls `f(array)` for each of the arrays that are saved (e.g. to
+     * the state file). `dir_x` and `dir_y` are skipped.
+     */
+    template<typename F> void for_each_saved_array(F f) const {
+        each_array(*this, f, false);
+    }
+
+    std::vector<RobotKind> kind;
+    /** @brief Left edges of the hitboxes. */
+    std::vector<double> x;
+    /** @brief Top edges of the hitboxes. */
+    std::vector<double> y;
+    /** @brief Half of the sizes of the hitboxes. */
+    std::vector<double> radius;
+    std::vector<double> angle;
+    /** @brief Cosines of `angle`, kept in sync with it. */
+    std::vector<double> dir_x;
+    /** @brief Sines of `angle`, kept in sync with it. */
+    std::vector<double> dir_y;
+    std::vector<double> mspeed;
+    std::vector<double> sspeed;
+    std::vector<double> rot_speed;
+    std::vector<double> rot_remain;
+    std::vector<double> elide_dist;
+    std::vector<double> elide_rot;
+    std::vector<double> cur_speed;
+    std::vector<double> cur_rot_speed;
+    std::vector<double> lidar_fov;
+    std::vector<std::uint32_t> lidar_rays;
+    // not `std::vector<bool>` so that it is not packed into bits
+    std::vector<unsigned char> grabbed;
+
+private:
+    template<typename S, typename F>
+    static void each_array(S &s, F &f, bool cached) {
+        f(s.kind);
+        f(s.x);
+        f(s.y);
+        f(s.radius);
+        f(s.angle);
+        if (cached) {
+            f(s.dir_x);
+            f(s.dir_y);
+        }
+        f(s.mspeed);
+        f(s.sspeed);
+        f(s.rot_speed);
+        f(s.rot_remain);
+        f(s.elide_dist);
+        f(s.elide_rot);
+        f(s.cur_speed);
+        f(s.cur_rot_speed);
+        f(s.lidar_fov);
+        f(s.lidar_rays);
+        f(s.grabbed);
+    }
+};
+
+/**
+ * @brief Complete state of the world. The simulation restored from it
+ * continues exactly as the simulation from which it was captured. Unlike the
+ * room file it contains also the internal state of the robots (e.g. remaining
+ * rotation of `Auto` robots).
+ */
+struct WorldState {
+    double width = 0;
+    double height = 0;
+    /** @brief Number of ticks simulated before the capture. */
+    std::uint64_t ticks = 0;
+    std::vector<ObstacleState> obstacles;
+    RobotArrays robots;
+
+    /**
+     * @brief Saves the state in the format of the room file, the same as
+     * `World::save` of the world restored from it.
+     * @param out Stream to write the state to.
+     * @param progress Called from time to time during the save.
+     */
+    void save(
+        std::ostream &out,
+        const Progress &progress = Progress()
+    ) const;
+
+    /**
+     * @brief Saves the state in the format of the room file. The text is
+     * written in large chunks.
+     * @param sink Where to write the state.
+     * @param progress Called from time to time during the save.
+     */
+    void save(Sink &sink, const Progress &progress = Progress()) const;
+};
+
+/**
+ * @brief Distances measured by the lidar of a robot. The rays are spread
+ * evenly over `RobotState::lidar_fov` from the left of the robot (the angle
+ * smaller than the orientation) to its right. Single ray goes straight
+ * forward.
+ */
+struct LidarScan {
+    /**
+     * @brief Distances of the closest obstacles from the edge of the robot,
+     * one for each ray.
+     */
+    const double *dists = nullptr;
+    /** @brief Number of the rays. */
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Algorithm used to find robots that collide with each other.
+ */
+enum class Broadphase {
+    /** @brief Check only robots in neighbouring cells of uniform grid. */
+    Grid,
+    /** @brief Check all pairs of robots. */
+    BruteForce,
+};
+
+/**
+ * @brief Algorithm used to find the distance of the closest obstacle in
+ * front of a robot.
+ */
+enum class Sensing {
+    /** @brief Traverse the tree of the obstacles along the 'ray'. */
+    Tree,
+    /**
+     * @brief Walk the cells of uniform grid along the 'ray' and test only the
+     * obstacles with edges in them. The time depends on the length of the
+     * 'ray' and not on the number of obstacles.
+     */
+    Grid,
+    /**
+     * @brief Skip the empty space using precomputed distances to the
+     * obstacles and walk the cells of the grid only near them. It is faster
+     * with many obstacles, but it takes memory and moving obstacles is
+     * slower.
+     */
+    DistanceField,
+};
+
+/**
+ * @brief Room with robots and obstacles without any graphical
+ * representation.
+ */
+class World {
+public:
+    /**
+     * @brief Creates new empty world.
+     * @param width Width of the room.
+     * @param height Height of the room.
+     */
+    World(double width = 0, double height = 0);
+
+    /**
+     * @brief Gets the width of the room.
+     */
+    double width() const { return mwidth; }
+
+    /**
+     * @brief Gets the height of the room.
+     */
+    double height() const { return mheight; }
+
+    /**
+     * @brief Sets the size of the room.
+     */
+    void set_size(double width, double height);
+
+    /**
+     * @brief Adds robot to the world.
+     * @return Index of the new robot.
+     */
+    std::size_t add_robot(RobotState robot);
+
+    /**
+     * @brief Adds obstacle to the world.
+     * @return Index of the new obstacle.
+     */
+    std::size_t add_obstacle(ObstacleState obstacle);
+
+    /**
+     * @brief Removes robot from the world. The last robot is moved to the
+     * index of the removed robot (in deterministic mode the robots after it
+     * are moved one index back).
+     */
+    void remove_robot(std::size_t idx);
+
+    /**
+     * @brief Removes obstacle from the world. The last obstacle is moved to
+     * the index of the removed obstacle (in deterministic mode the obstacles
+     * after it are moved one index back).
+     */
+    void remove_obstacle(std::size_t idx);
+
+    /**
+     * @brief Gets robot at the given index.
+     */
+    RobotState robot(std::size_t idx) const { return mrobots.get(idx); }
+
+    /**
+     * @brief Changes robot at the given index.
+     */
+    void set_robot(std::size_t idx, const RobotState &robot);
+
+    /**
+     * @brief Moves robot at the given index. The rest of its state is kept.
+     * @param idx Index of the robot.
+     * @param position New top-left corner of its hitbox.
+     */
+    void move_robot(std::size_t idx, Vec2 position);
+
+    /**
+     * @brief Sets the speed of robot at the given index as
+     * `RobotState::set_speed`. The rest of its state is kept.
+     */
+    void set_robot_speed(std::size_t idx, double speed);
+
+    /**
+     * @brief Sets the orientation of robot at the given index. The rest of
+     * its state is kept.
+     */
+    void set_robot_angle(std::size_t idx, double angle);
+
+    /**
+     * @brief Sets whether robot at the given index is held by the user. The
+     * rest of its state is kept.
+     */
+    void set_robot_grabbed(std::size_t idx, bool grabbed);
+
+    /**
+     * @brief Sets the parameters of the behaviour of robot at the given
+     * index (`rot_speed`, `elide_dist`, `elide_rot`, `cur_speed` and
+     * `cur_rot_speed`). Its position, orientation and the rest of its state
+     * are kept.
+     */
+    void set_robot_params(std::size_t idx, const RobotState &robot);
+
+    /**
+     * @brief Gets obstacle at the given index.
+     */
+    const ObstacleState &obstacle(std::size_t idx) const {
+        return mobstacles[idx];
+    }
+
+    /**
+     * @brief Changes obstacle at the given index.
+     */
+    void set_obstacle(std::size_t idx, ObstacleState obstacle);
+
+    /**
+     * @brief Gets all the robots in the world.
+     */
+    const RobotArrays &robots() const { return mrobots; }
+
+    /**
+     * @brief Gets all the obstacles in the world.
+     */
+    const std::vector<ObstacleState> &obstacles() const {
+        return mobstacles;
+    }
+
+    /**
+     * @brief Advances the simulation.
+     * @param delta Elapsed time in seconds.
+     */
+    void tick(double delta);
+
+    /**
+     * @brief Gets the number of ticks simulated so far.
+     */
+    std::uint64_t ticks() const { return mticks; }
+
+    /**
+     * @brief Captures the complete state of the world. It is just a copy of
+     * the arrays of the robots and obstacles.
+     */
+    WorldState state() const;
+
+    /**
+     * @brief Replaces the whole world with the captured state. The
+     * algorithm used to find colliding robots and the deterministic mode are
+     * kept.
+     */
+    void restore(const WorldState &state);
+
+    /**
+     * @brief Saves the world in the format of the room file.
+     * @param out Stream to write the world to.
+     * @param progress Called from time to time during the save.
+     */
+    void save(
+        std::ostream &out,
+        const Progress &progress = Progress()
+    ) const;
+
+    /**
+     * @brief Saves the world in the format of the room file. The text is
+     * written in large chunks.
+     * @param sink Where to write the world (e.g. `StringSink` to save it to
+     * memory).
+     * @param progress Called from time to time during the save.
+     */
+    void save(Sink &sink, const Progress &progress = Progress()) const;
+
+    /**
+     * @brief Gets the algorithm used to find colliding robots.
+     */
+    Broadphase broadphase() const { return mbroadphase; }
+
+    /**
+     * @brief Sets the algorithm used to find colliding robots.
+     */
+    void set_broadphase(Broadphase broadphase);
+
+    /**
+     * @brief Checks whether the world is in deterministic mode.
+     */
+    bool deterministic() const { return mdeterministic; }
+
+    /**
+     * @brief Sets deterministic mode. In deterministic mode the robots and
+     * obstacles keep the order in which they were added (removal doesn't
+     * swap them) and all the colliding robots are pushed apart by the
+     * overlaps at the start of the phase (the pushes of each robot are
+     * summed in the order of the indexes of the other robots). The result
+     * then depends only on the initial state and on the changes made between
+     * the ticks, not on the broadphase or on the order in which the pairs are
+     * found. It is the reference to which faster implementations are
+     * compared.
+     */
+    void set_deterministic(bool deterministic);
+
+    /**
+     * @brief Gets the algorithm used to find the distance of the closest
+     * obstacle in front of a robot.
+     */
+    Sensing sensing() const { return msensing; }
+
+    /**
+     * @brief Sets the algorithm used to find the distance of the closest
+     * obstacle in front of a robot. The results of all the algorithms are
+     * the same up to rounding.
+     */
+    void set_sensing(Sensing sensing);
+
+    /**
+     * @brief Checks whether the robots see the other robots.
+     */
+    bool robot_sensing() const { return mrobot_sensing; }
+
+    /**
+     * @brief Sets whether the robots see the other robots as obstacles (in
+     * the distance in front of them and in their lidars). The robots are
+     * circles and they are found in the grid of the robots (or among all the
+     * robots with `Broadphase::BruteForce`, the results are the same). It is
+     * enabled by default.
+     */
+    void set_robot_sensing(bool sensing);
+
+    /**
+     * @brief Gets the distances measured by the lidar of the robot in the
+     * last tick (before the robots moved). It is empty for robots without
+     * lidar, for grabbed robots and for robots added after the tick. The
+     * distances are valid until the next tick.
+     */
+    LidarScan lidar(std::size_t idx) const;
+
+    /**
+     * @brief Gets the durations of the phases of the recent ticks.
+     */
+    const Profiler &profiler() const { return mprofiler; }
+
+private:
+    void move_robots(double delta);
+    void steer_robot(
+        std::size_t idx,
+        double delta,
+        double distance,
+        LidarScan scan
+    );
+    void obstacle_collisions();
+    void robot_collisions();
+    void deterministic_robot_collisions();
+    // calls `f(i, j)` for all the pairs of robots that are not grabbed
+    template<typename F> void for_each_robot_pair(F &&f);
+    void border_collision(std::size_t idx);
+    // distance in front of the robot to the closest obstacle, other robots
+    // are considered only as far as the steering depends on them
+    double obstacle_distance(std::size_t idx);
+    // distance of the closest robot other than `idx` along the 'ray'
+    double robot_distance(std::size_t idx, Vec2 p, Vec2 d, double max) const;
+    // measures the distances by the lidars of all the robots
+    void cast_lidars();
+    // sets `lidar_offsets` to the directions of the rays relative to the
+    // orientation
+    void lidar_directions(std::uint32_t rays, double fov);
+    // the obstacle was added to or removed from the world
+    void obstacle_changed(const ObstacleState &obstacle, bool added);
+    void update_obstacles();
+
+    std::vector<ObstacleState> mobstacles;
+    RobotArrays mrobots;
+
+    double mwidth;
+    double mheight;
+    std::uint64_t mticks;
+
+    Broadphase mbroadphase;
+    RobotGrid grid;
+    bool mdeterministic;
+    // reused buffer for the robots whose angle changed in the tick
+    std::vector<std::uint32_t> turned;
+    // reused buffer for the pairs of robots from the grid (`i << 32 | j`)
+    std::vector<std::uint64_t> pairs;
+    // reused buffers for the summed pushes of the robots
+    std::vector<double> push_x;
+    std::vector<double> push_y;
+
+    ObstacleTree tree;
+    // the tree must be rebuilt before it is used
+    bool tree_dirty;
+    // reused buffer for obstacles that may collide with a robot
+    std::vector<std::uint32_t> candidates;
+
+    Sensing msensing;
+    // grid of the obstacles, `RobotGrid` is `grid`
+    ObstacleGrid cells;
+    DistanceField field;
+    // the whole grid (and field) must be rebuilt before it is used
+    bool cells_dirty;
+    // obstacles that must be added to or removed from the grid before it is
+    // used
+    struct CellChange {
+        Rect hitbox;
+        bool added;
+    };
+    std::vector<CellChange> cell_changes;
+
+    bool mrobot_sensing;
+
+    // the rays of robot `i` are in `lidar_dists` from `lidar_first[i]` to
+    // `lidar_first[i + 1]`
+    std::vector<std::size_t> lidar_first;
+    std::vector<double> lidar_dists;
+    // directions of the rays relative to the orientation (cosine and sine),
+    // shared by the robots with the same lidar
+    std::vector<Vec2> lidar_offsets;
+    std::uint32_t offsets_rays;
+    double offsets_fov;
+    // reused buffer for the directions of the rays of a robot
+    std::vector<Vec2> lidar_dirs;
+
+    Profiler mprofiler;
+};
+
+} // namespace icp